@@ -20,7 +20,8 @@ src/idl_gen_fbs.cpp \
 src/idl_gen_general.cpp \
 src/idl_gen_go.cpp \
 src/idl_gen_text.cpp \
-src/idl_parser.cpp
+src/idl_parser.cpp \
+src/idl_verifier.cpp
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/include
 LOCAL_EXPORT_C_INCLUDES := $(LOCAL_C_INCLUDES)
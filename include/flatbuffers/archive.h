@@ -0,0 +1,315 @@
+/*
+ * Copyright 2015 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLATBUFFERS_ARCHIVE_H_
+#define FLATBUFFERS_ARCHIVE_H_
+
+#include "flatbuffers/flatbuffers.h"
+#include "flatbuffers/stream.h"
+#include "flatbuffers/util.h"
+
+// Archives: many buffers in a single file, any of which can be accessed in
+// place in constant time, by position or by an optional key.
+//
+// Layout, all integers little endian:
+//   buffers    each starting at a multiple of 8 bytes, padded with zeros.
+//   offsets    uint64 per buffer: where it starts.
+//   sizes      uint32 per buffer, padded to 8 bytes.
+// if there are keys:
+//   key_ends   uint64 per buffer: end of its key in `keys` (the start being
+//              the end of the previous one). Buffers without one have an
+//              empty key.
+//   slots      uint32 * key_slots: hash table of buffers by key (index + 1,
+//              0 for empty slots), open addressing with linear probing on
+//              HashKey(key), padded to 8 bytes.
+//   keys       all keys back to back, padded to 8 bytes.
+// then the footer (kArchiveFooterSize bytes):
+//   uint64 index_offset  where the offsets start.
+//   uint64 count         number of buffers.
+//   uint64 key_bytes     size of `keys`, unpadded.
+//   uint32 key_slots     0 if there are no keys, a power of 2 otherwise.
+//   char[4]              kArchiveIdentifier.
+
+namespace flatbuffers {
+
+static const char kArchiveIdentifier[] = "FBA1";
+static const size_t kArchiveFooterSize = 32;
+
+// Writes an archive to a file descriptor, which must be at the start of an
+// empty file. Buffers are written as they are added; the index is kept in
+// memory (about 16 bytes per buffer, plus the keys) until Finish().
+class ArchiveWriter {
+ public:
+  explicit ArchiveWriter(int fd)
+    : writer_(fd), size_(0), has_keys_(false), ok_(true) {}
+
+  // Append the finished buffer in `fbb`, with `key` if not null. Buffers
+  // made of multiple segments are written without flattening them first.
+  bool Add(const FlatBufferBuilder &fbb, const char *key = nullptr) {
+    fbb.GetBufferSpans(&spans_);
+    return AddSpans(spans_.empty() ? nullptr : &spans_[0], spans_.size(),
+                    key);
+  }
+
+  // Append a buffer from memory.
+  bool Add(const uint8_t *buf, size_t len, const char *key = nullptr) {
+    BufferSpan span = { buf, len };
+    return AddSpans(&span, 1, key);
+  }
+
+  // Number of buffers added so far.
+  size_t size() const { return offsets_.size(); }
+
+  // Write the index, after which nothing can be added. Returns false if
+  // any write failed, in which case the archive is incomplete.
+  bool Finish() {
+    Pad();
+    AUTO_VAR(index_offset, size_);
+    AUTO_VAR(count, offsets_.size());
+    WriteScalars(offsets_);
+    WriteScalars(sizes_);
+    Pad();
+    uint32_t key_slots = 0;
+    if (has_keys_) {
+      WriteScalars(key_ends_);
+      key_slots = 1;
+      while (key_slots < 2 * count) key_slots *= 2;
+      std::vector<uint32_t> slots(key_slots, 0);
+      for (size_t i = 0; i < count; i++) {
+        AUTO_VAR(start, i ? key_ends_[i - 1] : 0);
+        if (start == key_ends_[i]) continue;  // No key.
+        AUTO_VAR(slot, HashKey(keys_.c_str() + start,
+                               static_cast<size_t>(key_ends_[i] - start)));
+        // The first buffer with a key is the one found for it.
+        while (slots[slot & (key_slots - 1)]) slot++;
+        slots[slot & (key_slots - 1)] = static_cast<uint32_t>(i + 1);
+      }
+      WriteScalars(slots);
+      Pad();
+      Write(reinterpret_cast<const uint8_t *>(keys_.data()), keys_.size());
+      Pad();
+    }
+    uint8_t footer[kArchiveFooterSize];
+    WriteScalar(footer, static_cast<uint64_t>(index_offset));
+    WriteScalar(footer + 8, static_cast<uint64_t>(count));
+    WriteScalar(footer + 16, static_cast<uint64_t>(keys_.size()));
+    WriteScalar(footer + 24, key_slots);
+    memcpy(footer + 28, kArchiveIdentifier, 4);
+    Write(footer, sizeof(footer));
+    return ok_;
+  }
+
+ private:
+  // Hash of a key in an archive, which (unlike HashKey(const char *)) may
+  // contain any bytes.
+  static uint32_t HashKey(const char *key, size_t len) {
+    return HashFnv1a<uint32_t>(reinterpret_cast<const uint8_t *>(key), len);
+  }
+  friend class ArchiveReader;
+
+  bool AddSpans(const BufferSpan *spans, size_t count, const char *key) {
+    Pad();
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++) len += spans[i].size;
+    assert(len <= 0xFFFFFFFFUL);  // The maximum size of any buffer.
+    offsets_.push_back(size_);
+    sizes_.push_back(static_cast<uint32_t>(len));
+    if (key) {
+      keys_ += key;
+      has_keys_ = true;
+    }
+    key_ends_.push_back(keys_.size());
+    ok_ = ok_ && writer_.WriteSpans(spans, count);
+    size_ += len;
+    return ok_;
+  }
+
+  template<typename T> void WriteScalars(const std::vector<T> &v) {
+    std::vector<T> le(v.size());
+    for (size_t i = 0; i < v.size(); i++) le[i] = EndianScalar(v[i]);
+    Write(le.empty() ? nullptr : reinterpret_cast<const uint8_t *>(&le[0]),
+          le.size() * sizeof(T));
+  }
+
+  void Write(const uint8_t *buf, size_t len) {
+    ok_ = ok_ && writer_.Write(buf, len);
+    size_ += len;
+  }
+
+  // Pad with zeros to the next multiple of 8 bytes.
+  void Pad() {
+    static const uint8_t zeros[sizeof(largest_scalar_t)] = { 0 };
+    Write(zeros, PaddingBytes(static_cast<size_t>(size_),
+                              sizeof(largest_scalar_t)));
+  }
+
+  StreamWriter writer_;
+  std::vector<BufferSpan> spans_;
+  uint64_t size_;  // Written so far.
+  std::vector<uint64_t> offsets_;
+  std::vector<uint32_t> sizes_;
+  std::vector<uint64_t> key_ends_;
+  std::string keys_;
+  bool has_keys_;
+  bool ok_;
+};
+
+// Reads an archive in place: nothing is copied, and opening it only checks
+// the footer, so the cost doesn't depend on the number of buffers in it.
+// All accesses are bounds checked, a corrupt archive gives null buffers,
+// but buffers themselves should still be verified if they're untrusted.
+class ArchiveReader {
+ public:
+  ArchiveReader() { Reset(); }
+
+  // Map archive file `name` (see MappedBuffer). Returns false if it can't
+  // be read, or isn't an archive.
+  bool Open(const char *name, MapAdvice advice = kMapRandom) {
+    return file_.Map(name, advice) && Open(file_.data(), file_.size());
+  }
+
+  // Use an archive in memory, which must stay valid while in use, and be
+  // aligned to 8 bytes.
+  bool Open(const uint8_t *data, size_t size) {
+    Reset();
+    if (size < kArchiveFooterSize) return false;
+    AUTO_VAR(footer, data + size - kArchiveFooterSize);
+    if (memcmp(footer + 28, kArchiveIdentifier, 4)) return false;
+    AUTO_VAR(index_offset, ReadScalar<uint64_t>(footer));
+    AUTO_VAR(count, ReadScalar<uint64_t>(footer + 8));
+    AUTO_VAR(key_bytes, ReadScalar<uint64_t>(footer + 16));
+    AUTO_VAR(key_slots, ReadScalar<uint32_t>(footer + 24));
+    // Check the index fits between index_offset and the footer, taking
+    // care not to overflow with made up numbers.
+    uint64_t index_size = size - kArchiveFooterSize;
+    if (index_offset > index_size || index_offset % 8) return false;
+    index_size -= index_offset;
+    if (count > index_size / 12) return false;
+    uint64_t needed = Align8(count * 12);
+    if (key_slots) {
+      if ((key_slots & (key_slots - 1)) || key_slots < count ||
+          key_bytes > index_size) return false;
+      needed += (count * 8) + Align8(key_slots * 4ULL) + Align8(key_bytes);
+    }
+    if (needed != index_size) return false;
+    data_ = data;
+    index_offset_ = index_offset;
+    count_ = static_cast<size_t>(count);
+    key_bytes_ = key_bytes;
+    key_slots_ = key_slots;
+    offsets_ = data + index_offset;
+    sizes_ = offsets_ + count * 8;
+    if (key_slots) {
+      key_ends_ = offsets_ + Align8(count * 12);
+      slots_ = key_ends_ + count * 8;
+      keys_ = slots_ + Align8(key_slots * 4ULL);
+    }
+    return true;
+  }
+
+  // Number of buffers.
+  size_t size() const { return count_; }
+
+  bool has_keys() const { return key_slots_ != 0; }
+
+  // The buffer at position `i` (and its size in `len` if not null), or null
+  // if there isn't one.
+  const uint8_t *Get(size_t i, size_t *len = nullptr) const {
+    if (i >= count_) return nullptr;
+    AUTO_VAR(offset, ReadScalar<uint64_t>(offsets_ + i * 8));
+    AUTO_VAR(size, ReadScalar<uint32_t>(sizes_ + i * 4));
+    if (offset > index_offset_ || size > index_offset_ - offset)
+      return nullptr;
+    if (len) *len = size;
+    return data_ + offset;
+  }
+
+  // The root table of the buffer at position `i`, or null.
+  template<typename T> const T *GetRoot(size_t i) const {
+    AUTO_VAR(buf, Get(i));
+    return buf ? flatbuffers::GetRoot<T>(buf) : nullptr;
+  }
+
+  // The key of the buffer at position `i` (not 0-terminated), and its
+  // length in `len`. Buffers without a key have an empty one.
+  const char *GetKey(size_t i, size_t *len) const {
+    *len = 0;
+    if (i >= count_ || !key_slots_) return nullptr;
+    AUTO_VAR(start, i ? ReadScalar<uint64_t>(key_ends_ + (i - 1) * 8) : 0);
+    AUTO_VAR(end, ReadScalar<uint64_t>(key_ends_ + i * 8));
+    if (start > end || end > key_bytes_) return nullptr;
+    *len = static_cast<size_t>(end - start);
+    return reinterpret_cast<const char *>(keys_ + start);
+  }
+
+  // Find the position of the (first) buffer with `key`. Returns false if
+  // there is none.
+  bool Find(const char *key, size_t *index) const {
+    if (!key_slots_) return false;
+    AUTO_VAR(len, strlen(key));
+    AUTO_VAR(slot, ArchiveWriter::HashKey(key, len));
+    for (uint32_t probe = 0; probe < key_slots_; probe++, slot++) {
+      AUTO_VAR(i, ReadScalar<uint32_t>(slots_ +
+                                       (slot & (key_slots_ - 1)) * 4));
+      if (!i) return false;
+      size_t found_len;
+      AUTO_VAR(found, GetKey(i - 1, &found_len));
+      if (found && found_len == len && !memcmp(found, key, len)) {
+        *index = i - 1;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // The buffer with `key`, or null.
+  const uint8_t *Lookup(const char *key, size_t *len = nullptr) const {
+    size_t i;
+    return Find(key, &i) ? Get(i, len) : nullptr;
+  }
+
+  // The root table of the buffer with `key`, or null.
+  template<typename T> const T *LookupRoot(const char *key) const {
+    AUTO_VAR(buf, Lookup(key));
+    return buf ? flatbuffers::GetRoot<T>(buf) : nullptr;
+  }
+
+ private:
+  // You shouldn't really be copying instances of this class.
+  ArchiveReader(const ArchiveReader &);
+  ArchiveReader &operator=(const ArchiveReader &);
+
+  void Reset() {
+    data_ = offsets_ = sizes_ = key_ends_ = slots_ = keys_ = nullptr;
+    index_offset_ = key_bytes_ = 0;
+    count_ = 0;
+    key_slots_ = 0;
+  }
+
+  static uint64_t Align8(uint64_t size) { return (size + 7) & ~7ULL; }
+
+  MappedBuffer file_;  // If opened by name.
+  const uint8_t *data_;
+  uint64_t index_offset_;
+  size_t count_;
+  uint64_t key_bytes_;
+  uint32_t key_slots_;
+  const uint8_t *offsets_, *sizes_, *key_ends_, *slots_, *keys_;
+};
+
+}  // namespace flatbuffers
+
+#endif  // FLATBUFFERS_ARCHIVE_H_
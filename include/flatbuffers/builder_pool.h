@@ -0,0 +1,183 @@
+/*
+ * Copyright 2015 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLATBUFFERS_BUILDER_POOL_H_
+#define FLATBUFFERS_BUILDER_POOL_H_
+
+#include "flatbuffers/flatbuffers.h"
+
+// Reusing FlatBufferBuilders, such that once they have grown to the size of
+// the buffers being built, building more of them doesn't allocate memory.
+
+#if (defined(_MSC_VER) && _MSC_VER < 1900) || defined(__BCPLUSPLUS__)
+  #define FLATBUFFERS_NO_THREAD_LOCAL
+#endif
+
+namespace flatbuffers {
+
+// Hands out builders, and takes them back with all their memory intact
+// (see FlatBufferBuilder::Clear()). Not thread-safe: use one pool per
+// thread, such as ThreadLocal().
+// To stop a single unusually big buffer from tying up memory forever, the
+// pool tracks the size of the biggest buffer built (the high-water mark)
+// over every `trim_interval` releases, and at the end of each interval
+// trims the builders it holds down to that size.
+// Settings changed on a builder (SetSegmentSize(), ForceDefaults() etc.)
+// stay in place when it goes back to the pool.
+class BuilderPool {
+ public:
+  // Builders are created with `initial_size` and `allocator`. Up to
+  // `max_builders` are kept when not in use, more are deleted on release.
+  explicit BuilderPool(uoffset_t initial_size = 1024,
+                       Allocator *allocator = nullptr,
+                       size_t max_builders = 4,
+                       size_t trim_interval = 1024)
+    : initial_size_(initial_size), allocator_(allocator),
+      max_builders_(max_builders), trim_interval_(trim_interval),
+      releases_(0), high_water_mark_(0), acquisitions_(0),
+      builders_created_(0), allocating_uses_(0), trims_(0) {
+    free_.reserve(max_builders);
+    in_use_.reserve(max_builders);
+  }
+
+  // All builders must have been released.
+  ~BuilderPool() {
+    assert(in_use_.empty());
+    for (AUTO_VAR(it, free_.begin()); it != free_.end(); ++it) delete *it;
+  }
+
+  // Get an empty builder, the most recently released one if any.
+  // Give it back with Release(), or use PooledBuilder to do so.
+  FlatBufferBuilder *Acquire() {
+    acquisitions_++;
+    FlatBufferBuilder *fbb;
+    if (free_.empty()) {
+      fbb = new FlatBufferBuilder(initial_size_, allocator_);
+      builders_created_++;
+    } else {
+      fbb = free_.back();
+      free_.pop_back();
+    }
+    InUse in_use = { fbb, fbb->GetMemoryUsage() };
+    in_use_.push_back(in_use);
+    return fbb;
+  }
+
+  // Return a builder obtained from Acquire(). Whatever it holds is cleared.
+  void Release(FlatBufferBuilder *fbb) {
+    AUTO_VAR(it, in_use_.end());
+    while (it != in_use_.begin() && (--it)->fbb != fbb) {}
+    assert(it != in_use_.end() && it->fbb == fbb);
+    high_water_mark_ = std::max(high_water_mark_,
+                                static_cast<size_t>(fbb->GetSize()));
+    fbb->Clear();
+    if (fbb->GetMemoryUsage() != it->memory_usage) allocating_uses_++;
+    *it = in_use_.back();
+    in_use_.pop_back();
+    if (free_.size() < max_builders_) free_.push_back(fbb);
+    else delete fbb;
+    if (++releases_ >= trim_interval_) Trim();
+  }
+
+  // Number of Acquire() calls.
+  size_t acquisitions() const { return acquisitions_; }
+
+  // Number of builders the pool had to create.
+  size_t builders_created() const { return builders_created_; }
+
+  // Number of times a builder's memory changed between Acquire() and
+  // Release(): it had to allocate, or its buffer was taken out with
+  // FlatBufferBuilder::Release(). Once warmed up, this stays the same, which
+  // means building buffers makes no heap allocations.
+  size_t allocating_uses() const { return allocating_uses_; }
+
+  // Number of times the builders were trimmed to the high-water mark.
+  size_t trims() const { return trims_; }
+
+  // Biggest buffer built in the current interval.
+  size_t high_water_mark() const { return high_water_mark_; }
+
+  // Trim the builders not in use to the high-water mark now, and start a
+  // new interval.
+  void Trim() {
+    AUTO_VAR(max_capacity, std::max(
+      (high_water_mark_ + sizeof(largest_scalar_t) - 1) &
+        ~(sizeof(largest_scalar_t) - 1),
+      static_cast<size_t>(initial_size_)));
+    for (AUTO_VAR(it, free_.begin()); it != free_.end(); ++it)
+      (*it)->Trim(max_capacity);
+    releases_ = 0;
+    high_water_mark_ = 0;
+    trims_++;
+  }
+
+#if !defined(FLATBUFFERS_NO_THREAD_LOCAL)
+  // A pool with default settings for the calling thread, destroyed when
+  // the thread exits.
+  static BuilderPool &ThreadLocal() {
+    static thread_local BuilderPool pool;
+    return pool;
+  }
+#endif
+
+ private:
+  // You shouldn't really be copying instances of this class.
+  BuilderPool(const BuilderPool &);
+  BuilderPool &operator=(const BuilderPool &);
+
+  struct InUse {
+    FlatBufferBuilder *fbb;
+    size_t memory_usage;  // At Acquire().
+  };
+
+  uoffset_t initial_size_;
+  Allocator *allocator_;
+  size_t max_builders_;
+  size_t trim_interval_;
+  size_t releases_;  // In the current interval.
+  size_t high_water_mark_;
+  size_t acquisitions_;
+  size_t builders_created_;
+  size_t allocating_uses_;
+  size_t trims_;
+  std::vector<FlatBufferBuilder *> free_;
+  std::vector<InUse> in_use_;
+};
+
+// Holds a builder from a BuilderPool for as long as it is in scope:
+//   PooledBuilder fbb(BuilderPool::ThreadLocal());
+//   FinishMonsterBuffer(*fbb, CreateMonster(*fbb, ...));
+class PooledBuilder {
+ public:
+  explicit PooledBuilder(BuilderPool &pool)
+    : pool_(&pool), fbb_(pool.Acquire()) {}
+  ~PooledBuilder() { pool_->Release(fbb_); }
+
+  FlatBufferBuilder &operator*() const { return *fbb_; }
+  FlatBufferBuilder *operator->() const { return fbb_; }
+  FlatBufferBuilder *get() const { return fbb_; }
+
+ private:
+  PooledBuilder(const PooledBuilder &);
+  PooledBuilder &operator=(const PooledBuilder &);
+
+  BuilderPool *pool_;
+  FlatBufferBuilder *fbb_;
+};
+
+}  // namespace flatbuffers
+
+#endif  // FLATBUFFERS_BUILDER_POOL_H_
@@ -27,8 +27,15 @@
 #include <vector>
 #include <algorithm>
 #include <functional>
+#include <utility>
 #include <memory>
 
+#include "flatbuffers/hash.h"
+
+#ifdef FLATBUFFERS_VERIFIER_STATS
+  #include <chrono>  // For VerifierStats::nanoseconds.
+#endif
+
 #if (!defined(__BCPLUSPLUS__) && __cplusplus <= 199711L) && \
 	(!defined(__BCPLUSPLUS__) || !defined(__TEMPLATES__) || __cplusplus != 1) && \
 	(!defined(_MSC_VER) || _MSC_VER < 1600) && \
@@ -99,6 +106,8 @@
 
     #define NO_UNIQUE_PTR
 
+    #define NO_MOVE_SEMANTICS
+
     #define USE_BOOST
   #else
     #define FLATBUFFERS_FINAL_CLASS final
@@ -126,6 +135,41 @@
   #define OVERRIDE override
 #endif
 
+// Hint that memory at `addr` will be read soon. Never faults, even if `addr`
+// isn't valid.
+#if defined(__GNUC__) || defined(__clang__)
+  #define FLATBUFFERS_PREFETCH(addr) __builtin_prefetch(addr)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+  #include <xmmintrin.h>
+  #define FLATBUFFERS_PREFETCH(addr) \
+    _mm_prefetch(reinterpret_cast<const char *>(addr), _MM_HINT_T0)
+#else
+  #define FLATBUFFERS_PREFETCH(addr)
+#endif
+
+// Vector instructions used where available, unless FLATBUFFERS_NO_SIMD is
+// defined. Everything using them has a scalar fallback.
+#if !defined(FLATBUFFERS_NO_SIMD)
+  #if defined(__SSE2__) || defined(_M_X64) || \
+      (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define FLATBUFFERS_SSE2
+  #elif defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define FLATBUFFERS_NEON
+  #endif
+#endif
+
+// Keep rarely taken paths out of line, so they don't bloat the code they are
+// called from.
+#if defined(__GNUC__) || defined(__clang__)
+  #define FLATBUFFERS_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+  #define FLATBUFFERS_NOINLINE __declspec(noinline)
+#else
+  #define FLATBUFFERS_NOINLINE
+#endif
+
 namespace flatbuffers {
 
 // Our default offset / size type, 32bit on purpose on 64bit systems.
@@ -207,6 +251,36 @@ template<typename T> void WriteScalar(void *p, T t) {
   *reinterpret_cast<T *>(p) = EndianScalar(t);
 }
 
+// Hash of a table key, as used by a hash index (see
+// FlatBufferBuilder::CreateKeyHashIndex()). Scalars are hashed in little
+// endian, with -0.0 the same as 0.0, so they hash the same everywhere.
+inline uint32_t HashKey(const char *key) {
+  return HashFnv1a<uint32_t>(key);
+}
+
+// Rather than the template below, which would hash the pointer.
+inline uint32_t HashKey(char *key) {
+  return HashKey(static_cast<const char *>(key));
+}
+
+template<typename T> uint32_t HashKey(T key) {
+  T le = EndianScalar(key == 0 ? T(0) : key);
+  return HashFnv1a<uint32_t>(reinterpret_cast<const uint8_t *>(&le),
+                             sizeof(T));
+}
+
+// The first 8 bytes of a string key as a big endian number, padded with 0s.
+// Keys compare the same as their prefixes, unless the prefixes are equal.
+// See FlatBufferBuilder::CreateKeyPrefixes().
+inline uint64_t KeyPrefix(const char *key) {
+  uint64_t prefix = 0;
+  for (int i = 0; i < 8; i++) {
+    prefix <<= 8;
+    if (*key) prefix |= static_cast<uint8_t>(*key++);
+  }
+  return prefix;
+}
+
 template<typename T> size_t AlignOf() {
   #ifdef _MSC_VER
     return __alignof(T);
@@ -377,7 +451,116 @@ public:
     return nullptr;  // Key not found.
   }
 
+  // Find the table with `key` through a hash index of this vector (see
+  // FlatBufferBuilder::CreateKeyHashIndex()), which takes about as many
+  // key comparisons as there are colliding keys, rather than log2(size()).
+  // Without an index, e.g. in a buffer from before it was added to the
+  // schema, this falls back to the binary search above, or to
+  // LookupByKeyEytzinger() if the vector is in `eytzinger` order.
+  template<typename K> return_type LookupByKey(
+                         K key, const Vector<uoffset_t> *hash_index,
+                         bool eytzinger = false) const {
+    if (!hash_index || !hash_index->size())
+      return eytzinger ? LookupByKeyEytzinger(key) : LookupByKey(key);
+    // The index is a power of 2 sized open addressing hash table of element
+    // indices + 1 (0 for empty slots), with linear probing. Its contents are
+    // not trusted to stay within bounds.
+    AUTO_VAR(mask, hash_index->size() - 1);
+    AUTO_VAR(slot, HashKey(key) & mask);
+    for (uoffset_t probes = 0; probes <= mask; probes++) {
+      AUTO_VAR(i, hash_index->Get(slot));
+      if (!i || i > size()) return nullptr;
+      AUTO_VAR(table, Get(i - 1));
+      if (!table->KeyCompareWithValue(key)) return table;
+      slot = (slot + 1) & mask;
+    }
+    return nullptr;
+  }
+
+  // Find the table with `key` in a vector in Eytzinger order (see
+  // FlatBufferBuilder::CreateVectorOfEytzingerTables()), where the tables
+  // compared with are near the start of the vector, and the ones that may be
+  // compared with next are next to each other. Which one that is depends
+  // only on the outcome of the comparison, not a branch, and the offsets to
+  // them are prefetched a few levels ahead.
+  template<typename K> return_type LookupByKeyEytzinger(K key) const {
+    size_t n = size();
+    size_t k = 1;  // Node k has children 2k and 2k + 1, stored at k - 1.
+    while (k <= n) {
+      // 4 levels further down, the descendants are 16 adjacent offsets.
+      FLATBUFFERS_PREFETCH(Data() + std::min(16 * k - 1, n) *
+                                    sizeof(uoffset_t));
+      AUTO_VAR(comp, Get(static_cast<uoffset_t>(k - 1))->
+                       KeyCompareWithValue(key));
+      k = 2 * k + (comp < 0);
+    }
+    // The last node where we went left is the first one not less than `key`:
+    // undo the steps right after it, and that step left.
+    while (k & 1) k >>= 1;
+    k >>= 1;
+    if (!k) return nullptr;
+    AUTO_VAR(table, Get(static_cast<uoffset_t>(k - 1)));
+    return table->KeyCompareWithValue(key) ? nullptr : table;
+  }
+
+  // Like LookupByKey(key) (or LookupByKeyEytzinger(key) if `eytzinger`) for
+  // string keys, but comparing with the prefixes of the keys first (see
+  // FlatBufferBuilder::CreateKeyPrefixes()). They are in a single array of
+  // integers, so tables are only looked at when their key starts with the
+  // same 8 bytes as `key`, rather than at every step. Without prefixes (or
+  // with the wrong number of them) this searches the tables directly.
+  return_type LookupByKeyPrefix(const char *key,
+                                const Vector<uint64_t> *key_prefixes,
+                                bool eytzinger = false) const {
+    if (!key_prefixes || key_prefixes->size() != size())
+      return eytzinger ? LookupByKeyEytzinger(key) : LookupByKey(key);
+    AUTO_VAR(prefix, KeyPrefix(key));
+    AUTO_VAR(prefixes, key_prefixes->Data());
+    if (eytzinger) {
+      size_t n = size();
+      size_t k = 1;
+      while (k <= n) {
+        // 3 levels further down, the descendants are 8 adjacent prefixes.
+        FLATBUFFERS_PREFETCH(prefixes + std::min(8 * k - 1, n) *
+                                        sizeof(uint64_t));
+        AUTO_VAR(comp, ComparePrefixed(static_cast<uoffset_t>(k - 1), key,
+                                       prefix, prefixes));
+        k = 2 * k + (comp < 0);
+      }
+      while (k & 1) k >>= 1;  // See LookupByKeyEytzinger().
+      k >>= 1;
+      if (!k) return nullptr;
+      AUTO_VAR(i, static_cast<uoffset_t>(k - 1));
+      return ComparePrefixed(i, key, prefix, prefixes) ? nullptr : Get(i);
+    }
+    AUTO_VAR(span, size());
+    uoffset_t start = 0;
+    while (span) {
+      AUTO_VAR(middle, span / 2);
+      AUTO_VAR(comp, ComparePrefixed(start + middle, key, prefix, prefixes));
+      if (comp > 0) {
+        span = middle;
+      } else if (comp < 0) {
+        middle++;
+        start += middle;
+        span -= middle;
+      } else {
+        return Get(start + middle);
+      }
+    }
+    return nullptr;
+  }
+
 protected:
+  // Compare the key of the table at `i` with `key`, which has `prefix`,
+  // going by the prefix of the table's key in `prefixes` if it differs.
+  int ComparePrefixed(uoffset_t i, const char *key, uint64_t prefix,
+                      const uint8_t *prefixes) const {
+    AUTO_VAR(p, ReadScalar<uint64_t>(prefixes + i * sizeof(uint64_t)));
+    if (p != prefix) return p < prefix ? -1 : 1;
+    return Get(i)->KeyCompareWithValue(key);
+  }
+
   // This class is only used to access pre-existing data. Don't ever
   // try to construct these manually.
   Vector();
@@ -385,6 +568,56 @@ protected:
   uoffset_t length_;
 };
 
+// Where the `rank`th smallest element (counting from 0) of a vector of
+// `size` elements in Eytzinger order is stored, for use with Vector::Get().
+// Takes O(log(size)^2). Iterating over such a vector visits all elements,
+// just not in sorted order.
+inline uoffset_t EytzingerIndex(uoffset_t rank, uoffset_t size) {
+  assert(rank < size);
+  size_t k = 1;
+  for (;;) {
+    // Count the nodes in the left subtree, level by level.
+    size_t left = 0;
+    for (size_t first = 2 * k, last = 2 * k; first <= size;
+         first *= 2, last = last * 2 + 1)
+      left += std::min(last, static_cast<size_t>(size)) - first + 1;
+    if (rank == left) return static_cast<uoffset_t>(k - 1);
+    if (rank < left) {
+      k = 2 * k;
+    } else {
+      rank -= static_cast<uoffset_t>(left + 1);
+      k = 2 * k + 1;
+    }
+  }
+}
+
+// Call `f` with each table in `vec` in order (like std::for_each(), and
+// returning `f` the same way), while prefetching the table `distance`
+// elements ahead. Scanning a big vector of tables is otherwise bound by
+// the latency of fetching each table, and then its vtable, from memory.
+// Half that distance ahead, the table should have arrived, so its vtable
+// is prefetched as well. The best distance depends on how much work `f`
+// does: the less it does, the further ahead it needs to look.
+template<typename T, typename F> F ForEachPrefetch(
+                      const Vector<Offset<T> > *vec, F f,
+                      uoffset_t distance = 8) {
+  if (!vec) return f;
+  AUTO_VAR(size, vec->size());
+  AUTO_VAR(vtable_distance, distance / 2);
+  for (uoffset_t i = 0; i < std::min(distance, size); i++)
+    FLATBUFFERS_PREFETCH(vec->Get(i));
+  for (uoffset_t i = 0; i < size; i++) {
+    if (distance < size - i) FLATBUFFERS_PREFETCH(vec->Get(i + distance));
+    if (vtable_distance && vtable_distance < size - i) {
+      AUTO_VAR(table, reinterpret_cast<const uint8_t *>(
+                        vec->Get(i + vtable_distance)));
+      FLATBUFFERS_PREFETCH(table - ReadScalar<soffset_t>(table));
+    }
+    f(vec->Get(i));
+  }
+  return f;
+}
+
 // Convenient helper function to get the length of any vector, regardless
 // of wether it is null or not (the field is not set).
 template<typename T> static inline size_t VectorLength(const Vector<T> *v) {
@@ -399,47 +632,337 @@ struct String : public Vector<char> {
   }
 };
 
-// Simple indirection for buffer allocation, to allow this to be overridden
-// with custom allocation (see the FlatBufferBuilder constructor).
-class simple_allocator {
+// Interface for the memory that backs a FlatBufferBuilder (see the
+// FlatBufferBuilder constructor). Allocators may be stateful (pools, arenas,
+// statistics), and are always told the size of the block they release, which
+// is the size that was requested from allocate() (or good_size() thereof).
+class Allocator {
+ public:
+  virtual ~Allocator() {}
+
+  // Allocate `size` bytes of memory.
+  virtual uint8_t *allocate(size_t size) = 0;
+
+  // Deallocate `size` bytes of memory at `p` allocated by this allocator.
+  virtual void deallocate(uint8_t *p, size_t size) = 0;
+
+  // The amount of memory a request for `size` bytes will actually provide.
+  // vector_downward asks for this so it can use any slack a size-class
+  // allocator would otherwise waste.
+  virtual size_t good_size(size_t size) const { return size; }
+};
+
+// Default allocator, using new/delete. It is stateless, so a single shared
+// instance serves all builders that don't specify an allocator.
+class DefaultAllocator : public Allocator {
+ public:
+  uint8_t *allocate(size_t size) OVERRIDE { return new uint8_t[size]; }
+
+  void deallocate(uint8_t *p, size_t /* size */) OVERRIDE { delete[] p; }
+
+  static DefaultAllocator &instance() {
+    static DefaultAllocator default_allocator;
+    return default_allocator;
+  }
+};
+
+// Deprecated: the allocator interface from before Allocator, here for
+// backwards compatibility. Allocators derived from it override the const
+// allocate() and deallocate() below as before, and can still be passed to
+// the FlatBufferBuilder constructor as a const pointer. New allocators
+// should derive from Allocator instead.
+class simple_allocator : public Allocator {
  public:
+  // Picks the FlatBufferBuilder constructor for these.
+  typedef simple_allocator deprecated_simple_allocator;
+
   virtual ~simple_allocator() {}
   virtual uint8_t *allocate(size_t size) const { return new uint8_t[size]; }
   virtual void deallocate(uint8_t *p) const { delete[] p; }
+
+  uint8_t *allocate(size_t size) OVERRIDE {
+    return static_cast<const simple_allocator *>(this)->allocate(size);
+  }
+
+  void deallocate(uint8_t *p, size_t /* size */) OVERRIDE {
+    static_cast<const simple_allocator *>(this)->deallocate(p);
+  }
+};
+
+// An allocator that recycles released blocks rather than returning them to
+// the heap. Requests are rounded up to power-of-two size classes from
+// kMinSlabSize up to max_slab_size, and freed blocks are kept on a free list
+// per class (at most max_free_per_class each) for the next allocation of
+// that class to pick up. Once warmed up, a steady-state workload of similarly
+// sized buffers is encoded without touching the heap at all.
+// Requests larger than max_slab_size go straight to the backing allocator.
+// Not thread-safe: use one instance per thread.
+class SlabAllocator : public Allocator {
+ public:
+  static const size_t kMinSlabSize = 64;
+
+  explicit SlabAllocator(size_t max_slab_size = 1 << 24,
+                         size_t max_free_per_class = 16,
+                         Allocator *backing = nullptr)
+    : backing_(backing ? backing : &DefaultAllocator::instance()),
+      max_free_per_class_(max_free_per_class),
+      heap_allocations_(0),
+      cached_bytes_(0) {
+    for (size_t s = kMinSlabSize; s <= max_slab_size; s *= 2) {
+      free_lists_.push_back(std::vector<uint8_t *>());
+      // Reserve up front, so recycling never allocates.
+      free_lists_.back().reserve(max_free_per_class_);
+    }
+  }
+
+  ~SlabAllocator() { Trim(); }
+
+  uint8_t *allocate(size_t size) OVERRIDE {
+    AUTO_VAR(cls, SizeClass(size));
+    if (cls < free_lists_.size()) {
+      AUTO_VAR(&free_list, free_lists_[cls]);
+      if (!free_list.empty()) {
+        uint8_t *p = free_list.back();
+        free_list.pop_back();
+        cached_bytes_ -= ClassSize(cls);
+        return p;
+      }
+      size = ClassSize(cls);
+    }
+    heap_allocations_++;
+    return backing_->allocate(size);
+  }
+
+  void deallocate(uint8_t *p, size_t size) OVERRIDE {
+    AUTO_VAR(cls, SizeClass(size));
+    if (cls < free_lists_.size()) {
+      size = ClassSize(cls);
+      AUTO_VAR(&free_list, free_lists_[cls]);
+      if (free_list.size() < max_free_per_class_) {
+        free_list.push_back(p);
+        cached_bytes_ += size;
+        return;
+      }
+    }
+    backing_->deallocate(p, size);
+  }
+
+  size_t good_size(size_t size) const OVERRIDE {
+    AUTO_VAR(cls, SizeClass(size));
+    return cls < free_lists_.size() ? ClassSize(cls) : size;
+  }
+
+  // Return all cached blocks to the backing allocator.
+  void Trim() {
+    for (size_t cls = 0; cls < free_lists_.size(); cls++) {
+      AUTO_VAR(&free_list, free_lists_[cls]);
+      for (size_t i = 0; i < free_list.size(); i++)
+        backing_->deallocate(free_list[i], ClassSize(cls));
+      free_list.clear();
+    }
+    cached_bytes_ = 0;
+  }
+
+  // Number of blocks obtained from the backing allocator so far. This stops
+  // increasing once the pool has warmed up.
+  size_t heap_allocations() const { return heap_allocations_; }
+
+  // Bytes currently held on the free lists.
+  size_t cached_bytes() const { return cached_bytes_; }
+
+ private:
+  // You shouldn't really be copying instances of this class.
+  SlabAllocator(const SlabAllocator &);
+  SlabAllocator &operator=(const SlabAllocator &);
+
+  static size_t ClassSize(size_t cls) { return kMinSlabSize << cls; }
+
+  // Returns free_lists_.size() if `size` is too big for any class.
+  size_t SizeClass(size_t size) const {
+    size_t cls = 0;
+    while (cls < free_lists_.size() && ClassSize(cls) < size) cls++;
+    return cls;
+  }
+
+  Allocator *backing_;
+  size_t max_free_per_class_;
+  size_t heap_allocations_;
+  size_t cached_bytes_;
+  std::vector<std::vector<uint8_t *> > free_lists_;
+};
+
+// Decides how many bytes vector_downward grows by when it runs out of space,
+// given its current capacity. vector_downward always grows by at least the
+// amount it needs, and rounds up to a multiple of sizeof(largest_scalar_t).
+typedef size_t (*GrowthPolicy)(size_t reserved);
+
+// Grows by 50% each time (the default).
+inline size_t DefaultGrowthPolicy(size_t reserved) { return reserved / 2; }
+
+// Doubles the capacity each time, trading memory for fewer copies.
+inline size_t DoublingGrowthPolicy(size_t reserved) { return reserved; }
+
+// A contiguous piece of a serialized buffer, see
+// FlatBufferBuilder::GetBufferSpans(). Has the same fields as a POSIX iovec,
+// so it is trivial to pass to writev().
+struct BufferSpan {
+  const uint8_t *data;
+  size_t size;
+};
+
+// A finished buffer taken out of a FlatBufferBuilder with Release(). Owns
+// the memory, and gives it back to the allocator it came from when
+// destroyed, so unlike unique_ptr_t no deleter needs to be stored.
+class DetachedBuffer {
+ public:
+  DetachedBuffer()
+    : allocator_(nullptr), buf_(nullptr), reserved_(0), cur_(nullptr),
+      size_(0) {}
+
+  // Takes ownership of `reserved` bytes at `buf` obtained from `allocator`,
+  // of which the last `size` hold the data.
+  DetachedBuffer(Allocator *allocator, uint8_t *buf, size_t reserved,
+                 size_t size)
+    : allocator_(allocator), buf_(buf), reserved_(reserved),
+      cur_(buf + reserved - size), size_(size) {}
+
+#if !defined(NO_MOVE_SEMANTICS)
+  DetachedBuffer(DetachedBuffer &&other)
+    : allocator_(nullptr), buf_(nullptr), reserved_(0), cur_(nullptr),
+      size_(0) {
+    swap(other);
+  }
+
+  DetachedBuffer &operator=(DetachedBuffer &&other) {
+    swap(other);
+    return *this;
+  }
+#endif
+
+  ~DetachedBuffer() {
+    if (buf_) allocator_->deallocate(buf_, reserved_);
+  }
+
+  const uint8_t *data() const { return cur_; }
+  uint8_t *data() { return cur_; }
+  size_t size() const { return size_; }
+
+  // Size of the whole memory block, which starts at data() - (capacity() -
+  // size()).
+  size_t capacity() const { return reserved_; }
+
+  Allocator *allocator() const { return allocator_; }
+
+  void swap(DetachedBuffer &other) {
+    std::swap(allocator_, other.allocator_);
+    std::swap(buf_, other.buf_);
+    std::swap(reserved_, other.reserved_);
+    std::swap(cur_, other.cur_);
+    std::swap(size_, other.size_);
+  }
+
+ private:
+  // You shouldn't really be copying instances of this class.
+  DetachedBuffer(const DetachedBuffer &);
+  DetachedBuffer &operator=(const DetachedBuffer &);
+
+  Allocator *allocator_;
+  uint8_t *buf_;
+  size_t reserved_;
+  uint8_t *cur_;
+  size_t size_;
 };
 
 // This is a minimal replication of std::vector<uint8_t> functionality,
 // except growing from higher to lower addresses. i.e push_back() inserts data
 // in the lowest address in the vector.
+// Memory is only allocated once the first byte is written.
+// By default all data is kept in one block that is reallocated as it grows.
+// With set_segment_size(), it instead grows by starting new segments below
+// the existing ones, which never move (and are reused after clear()).
+// Offsets (sizes counting from the end) are the same in either case, and
+// data_at() finds the segment they are in.
+// An object between begin_object() and end_object() is never split across
+// segments.
+// With set_measure_only(), nothing is stored at all, only the size is
+// tracked. With set_external_buffer(), data goes into memory owned by the
+// caller, and rather than growing, it overflows into measuring.
 class vector_downward {
  public:
-  explicit vector_downward(size_t initial_size,
-                           const simple_allocator &allocator)
-    : reserved_(initial_size),
-      buf_(allocator.allocate(reserved_)),
-      cur_(buf_ + reserved_),
-      allocator_(allocator) {
+  explicit vector_downward(size_t initial_size, Allocator &allocator,
+                           GrowthPolicy growth_policy = DefaultGrowthPolicy)
+    : initial_size_(initial_size),
+      segment_size_(0),
+      reserved_(0),
+      buf_(nullptr),
+      cur_(nullptr),
+      top_(nullptr),
+      size_base_(0),
+      object_start_(kNoObject),
+      measure_only_(false),
+      external_(false),
+      overflowed_(false),
+      allocator_(&allocator),
+      growth_policy_(growth_policy) {
     assert((initial_size & (sizeof(largest_scalar_t) - 1)) == 0);
   }
 
+#if !defined(NO_MOVE_SEMANTICS)
+  // Leaves `other` empty, without any memory.
+  vector_downward(vector_downward &&other)
+    : initial_size_(other.initial_size_),
+      segment_size_(other.segment_size_),
+      reserved_(0),
+      buf_(nullptr),
+      cur_(nullptr),
+      top_(nullptr),
+      size_base_(0),
+      object_start_(kNoObject),
+      measure_only_(false),
+      external_(false),
+      overflowed_(false),
+      allocator_(other.allocator_),
+      growth_policy_(other.growth_policy_) {
+    swap(other);
+  }
+
+  vector_downward &operator=(vector_downward &&other) {
+    swap(other);
+    return *this;
+  }
+#endif
+
   ~vector_downward() {
-    if (buf_)
-      allocator_.deallocate(buf_);
+    free_segments();
+    free_spares();
+    if (buf_ && !external_)
+      allocator_->deallocate(buf_, reserved_);
   }
 
+  // Keeps all memory around for reuse: the most recent segment stays the
+  // current one, earlier segments become spares for add_segment().
   void clear() {
-    if (buf_ == nullptr)
-      buf_ = allocator_.allocate(reserved_);
-
-    cur_ = buf_ + reserved_;
+    spares_.insert(spares_.end(), segments_.begin(), segments_.end());
+    segments_.clear();
+    top_ = buf_ + reserved_;
+    cur_ = top_;
+    size_base_ = 0;
+    object_start_ = kNoObject;
+    if (overflowed_) {
+      measure_only_ = false;
+      overflowed_ = false;
+    }
   }
 
 #if !defined(NO_UNIQUE_PTR)
   // Relinquish the pointer to the caller.
+  // Only possible while all data is in a single segment.
   unique_ptr_t release() {
+    assert(segments_.empty() && !external_);
+
     // Actually deallocate from the start of the allocated memory.
     std::function<void(uint8_t *)> deleter(
-      std::bind(&simple_allocator::deallocate, allocator_, buf_));
+      std::bind(&Allocator::deallocate, allocator_, buf_, reserved_));
 
     // Point to the desired offset.
     unique_ptr_t retval(data(), deleter);
@@ -447,69 +970,388 @@ class vector_downward {
     // Don't deallocate when this instance is destroyed.
     buf_ = nullptr;
     cur_ = nullptr;
+    top_ = nullptr;
+    reserved_ = 0;
 
     return retval;
   }
 #endif
 
-  size_t growth_policy(size_t bytes) {
-    return (bytes / 2) & ~(sizeof(largest_scalar_t) - 1);
+#if !defined(NO_MOVE_SEMANTICS)
+  // Hand over all data, as a single block (copying it into one if it is
+  // spread over multiple segments). Leaves this empty, without memory.
+  DetachedBuffer detach() {
+    assert(!external_);
+    if (!segments_.empty()) {
+      AUTO_VAR(sz, size());
+      AUTO_VAR(reserved, allocator_->good_size(
+        (sz + sizeof(largest_scalar_t) - 1) & ~(sizeof(largest_scalar_t) - 1)));
+      AUTO_VAR(flat, allocator_->allocate(reserved));
+      copy_to(flat + reserved - sz);
+      free_segments();
+      allocator_->deallocate(buf_, reserved_);
+      buf_ = flat;
+      reserved_ = reserved;
+      top_ = flat + reserved;
+      cur_ = top_ - sz;
+      size_base_ = 0;
+    }
+    DetachedBuffer detached(allocator_, buf_, reserved_,
+                            static_cast<size_t>(top_ - cur_));
+    buf_ = nullptr;
+    cur_ = nullptr;
+    top_ = nullptr;
+    reserved_ = 0;
+    object_start_ = kNoObject;
+    return detached;
   }
+#endif
 
-  uint8_t *make_space(size_t len) {
-    if (len > static_cast<size_t>(cur_ - buf_)) {
-      AUTO_VAR(old_size, size());
-      reserved_ += std::max(len, growth_policy(reserved_));
-      AUTO_VAR(new_buf, allocator_.allocate(reserved_));
-      AUTO_VAR(new_cur, new_buf);
-      new_cur += reserved_ - old_size;
-      memcpy(new_cur, cur_, old_size);
-      cur_ = new_cur;
-      allocator_.deallocate(buf_);
-      buf_ = new_buf;
+  void swap(vector_downward &other) {
+    std::swap(initial_size_, other.initial_size_);
+    std::swap(segment_size_, other.segment_size_);
+    std::swap(reserved_, other.reserved_);
+    std::swap(buf_, other.buf_);
+    std::swap(cur_, other.cur_);
+    std::swap(top_, other.top_);
+    std::swap(size_base_, other.size_base_);
+    std::swap(object_start_, other.object_start_);
+    segments_.swap(other.segments_);
+    spares_.swap(other.spares_);
+    std::swap(measure_only_, other.measure_only_);
+    std::swap(external_, other.external_);
+    std::swap(overflowed_, other.overflowed_);
+    scratch_.swap(other.scratch_);
+    std::swap(allocator_, other.allocator_);
+    std::swap(growth_policy_, other.growth_policy_);
+  }
+
+  void set_growth_policy(GrowthPolicy growth_policy) {
+    growth_policy_ = growth_policy;
+  }
+
+  // Grow by adding segments of at least `segment_size` bytes instead of
+  // reallocating, or go back to reallocating with 0. Only while empty.
+  void set_segment_size(size_t segment_size) {
+    assert(!size());
+    segment_size_ = (segment_size + sizeof(largest_scalar_t) - 1) &
+                    ~(sizeof(largest_scalar_t) - 1);
+  }
+
+  // Only count the bytes written from now on, without storing them: the
+  // memory returned by make_space() etc. is scratch space that gets reused.
+  // Only while empty.
+  void set_measure_only(bool measure_only) {
+    assert(!size());
+    measure_only_ = measure_only;
+  }
+
+  bool measure_only() const { return measure_only_; }
+
+  // Write into `size` bytes at `buf` instead of allocating memory, or go
+  // back to allocating if `buf` is nullptr. Only while empty.
+  void set_external_buffer(uint8_t *buf, size_t size) {
+    assert(!this->size() && segments_.empty());
+    if (buf_ && !external_) allocator_->deallocate(buf_, reserved_);
+    // The end must be aligned, as the data is aligned relative to it.
+    size_t reserved = 0;
+    if (buf) {
+      AUTO_VAR(end, (reinterpret_cast<size_t>(buf) + size) &
+                    ~(sizeof(largest_scalar_t) - 1));
+      if (end > reinterpret_cast<size_t>(buf))
+        reserved = end - reinterpret_cast<size_t>(buf);
     }
-    cur_ -= len;
-    // Beyond this, signed offsets may not have enough range:
-    // (FlatBuffers > 2GB not supported).
-    assert(size() < (1UL << (sizeof(soffset_t) * 8 - 1)) - 1);
-    return cur_;
+    external_ = buf != nullptr;
+    overflowed_ = false;
+    buf_ = buf;
+    reserved_ = reserved;
+    clear();
+  }
+
+  // True if the external buffer was too small. Everything written since
+  // was only measured.
+  bool overflowed() const { return overflowed_; }
+
+  // Make sure `len` more bytes can be written without reallocating.
+  void reserve(size_t len) {
+    if (len > static_cast<size_t>(cur_ - buf_) && !external_) grow(len);
+  }
+
+  // Room for `len` more bytes, to be written by the caller. If they're only
+  // measured, this is scratch space, which with an external buffer is that
+  // buffer, or nullptr if `len` doesn't fit in it (so it never allocates).
+  uint8_t *make_space(size_t len) {
+    return claim(len) ? cur_ : scratch(len);
   }
 
   uoffset_t size() const {
-    assert(cur_ != nullptr && buf_ != nullptr);
-    return static_cast<uoffset_t>(reserved_ - (cur_ - buf_));
+    return static_cast<uoffset_t>(size_base_ + (top_ - cur_));
+  }
+
+  // True if all data is in a single segment.
+  bool contiguous() const { return segments_.empty(); }
+
+  size_t capacity() const {
+    AUTO_VAR(total, reserved_);
+    for (AUTO_VAR(it, segments_.begin()); it != segments_.end(); ++it)
+      total += it->reserved;
+    for (AUTO_VAR(it, spares_.begin()); it != spares_.end(); ++it)
+      total += it->reserved;
+    return total;
+  }
+
+  // All memory held, including bookkeeping. Only ever goes up while data
+  // is written, so if it hasn't changed, nothing was allocated.
+  size_t memory_usage() const {
+    return (external_ ? capacity() - reserved_ : capacity()) +
+           scratch_.capacity() +
+           (segments_.capacity() + spares_.capacity()) * sizeof(Segment);
   }
 
-  uint8_t *data() const {
-    assert(cur_ != nullptr);
-    return cur_;
+  // Free the memory kept for reuse beyond `max_capacity` bytes: spare
+  // segments, and the current block if it is bigger (it is replaced by one
+  // of `max_capacity` bytes, if that is at least the initial size).
+  // Only while empty.
+  void shrink(size_t max_capacity) {
+    assert(!size());
+    free_spares();
+    std::vector<Segment>().swap(spares_);
+    if (scratch_.capacity() > max_capacity)
+      std::vector<uint8_t>().swap(scratch_);
+    if (!buf_ || external_ || reserved_ <= max_capacity) return;
+    allocator_->deallocate(buf_, reserved_);
+    buf_ = cur_ = top_ = nullptr;
+    reserved_ = 0;
+    if (max_capacity >= initial_size_) reallocate(max_capacity);
   }
 
-  uint8_t *data_at(size_t offset) { return buf_ + reserved_ - offset; }
+  // Returns nullptr if nothing has been written yet.
+  // With multiple segments, this is the start of the most recent one only.
+  uint8_t *data() const { return cur_; }
+
+  uint8_t *data_at(size_t offset) {
+    if (offset > size_base_) return top_ - (offset - size_base_);
+    if (measure_only_) return reinterpret_cast<uint8_t *>(&sink_);
+    AUTO_VAR(seg, find_segment(offset));
+    return seg->top - (offset - seg->base);
+  }
 
   // push() & fill() are most frequently called with small byte counts (<= 4),
   // which is why we're using loops rather than calling memcpy/memset.
   void push(const uint8_t *bytes, size_t num) {
-    AUTO_VAR(dest, make_space(num));
-    for (size_t i = 0; i < num; i++) dest[i] = bytes[i];
+    if (!claim(num)) return;
+    for (size_t i = 0; i < num; i++) cur_[i] = bytes[i];
   }
 
   void fill(size_t zero_pad_bytes) {
-    AUTO_VAR(dest, make_space(zero_pad_bytes));
-    for (size_t i = 0; i < zero_pad_bytes; i++) dest[i] = 0;
+    if (!claim(zero_pad_bytes)) return;
+    for (size_t i = 0; i < zero_pad_bytes; i++) cur_[i] = 0;
+  }
+
+  void pop(size_t bytes_to_remove) {
+    if (measure_only_) size_base_ -= static_cast<uoffset_t>(bytes_to_remove);
+    else cur_ += bytes_to_remove;
   }
 
-  void pop(size_t bytes_to_remove) { cur_ += bytes_to_remove; }
+  // Everything written from here until end_object() stays contiguous.
+  // If the size of the object is known up front, passing it avoids having
+  // to move the object to a new segment halfway through.
+  void begin_object(size_t len = 0) {
+    object_start_ = size();
+    if (segment_size_ && len > static_cast<size_t>(cur_ - buf_))
+      grow(len);
+  }
+  void end_object() { object_start_ = kNoObject; }
+
+  // Appends the data to `spans` as contiguous pieces, lowest offset first.
+  void spans(std::vector<BufferSpan> *spans) const {
+    if (cur_ != top_) {
+      BufferSpan span = { cur_, static_cast<size_t>(top_ - cur_) };
+      spans->push_back(span);
+    }
+    for (AUTO_VAR(it, segments_.rbegin()); it != segments_.rend(); ++it) {
+      BufferSpan span = { it->top - it->size, it->size };
+      spans->push_back(span);
+    }
+  }
+
+  // Copies all data to `dest`, which must have room for size() bytes.
+  void copy_to(uint8_t *dest) const {
+    if (cur_ != top_) {
+      memcpy(dest, cur_, top_ - cur_);
+      dest += top_ - cur_;
+    }
+    for (AUTO_VAR(it, segments_.rbegin()); it != segments_.rend(); ++it) {
+      memcpy(dest, it->top - it->size, it->size);
+      dest += it->size;
+    }
+  }
 
  private:
   // You shouldn't really be copying instances of this class.
   vector_downward(const vector_downward &);
   vector_downward &operator=(const vector_downward &);
 
+  // A segment that has been filled, the current one lives in buf_ etc.
+  struct Segment {
+    uint8_t *buf;
+    size_t reserved;
+    uint8_t *top;    // End of the data in this segment.
+    uoffset_t base;  // The size() corresponding to `top`.
+    uoffset_t size;  // Bytes of data below `top`.
+  };
+
+  static const size_t kNoObject = ~static_cast<size_t>(0);
+
+  // Returns false if the bytes shouldn't be stored at all.
+  bool grow(size_t len) {
+    if (measure_only_) return false;
+    if (external_) {
+      // Keep counting, such that the caller knows how much space it needs.
+      size_base_ = size();
+      top_ = cur_ = buf_;
+      measure_only_ = true;
+      overflowed_ = true;
+      return false;
+    }
+    if (segment_size_) add_segment(len);
+    else reallocate(len);
+    return true;
+  }
+
+  // Make room for `len` bytes at cur_, or if they aren't to be stored,
+  // only account for them and return false.
+  bool claim(size_t len) {
+    bool stored = len <= static_cast<size_t>(cur_ - buf_) || grow(len);
+    if (stored) cur_ -= len;
+    else size_base_ += static_cast<uoffset_t>(len);
+    // Beyond this, signed offsets may not have enough range:
+    // (FlatBuffers > 2GB not supported).
+    assert(size() < (1UL << (sizeof(soffset_t) * 8 - 1)) - 1);
+    return stored;
+  }
+
+  // Memory that bytes which are not stored can be written to.
+  uint8_t *scratch(size_t len) {
+    // After an overflow, the external buffer is as good as any.
+    if (external_) return len <= reserved_ ? buf_ : nullptr;
+    if (scratch_.size() < len)
+      scratch_.resize(std::max(len, sizeof(largest_scalar_t)));
+    return &scratch_[0];
+  }
+
+  // Grow the buffer such that at least `len` more bytes fit, moving the
+  // data written so far to the end of the new buffer.
+  void reallocate(size_t len) {
+    assert(segments_.empty());
+    AUTO_VAR(old_reserved, reserved_);
+    AUTO_VAR(old_size, size());
+    size_t new_reserved = buf_
+      ? old_reserved + std::max(len, growth_policy_(old_reserved))
+      : std::max(len, initial_size_);
+    new_reserved = (new_reserved + sizeof(largest_scalar_t) - 1) &
+                   ~(sizeof(largest_scalar_t) - 1);
+    new_reserved = allocator_->good_size(new_reserved);
+    AUTO_VAR(new_buf, allocator_->allocate(new_reserved));
+    AUTO_VAR(new_cur, new_buf + new_reserved - old_size);
+    if (buf_) {
+      memcpy(new_cur, cur_, old_size);
+      allocator_->deallocate(buf_, old_reserved);
+    }
+    reserved_ = new_reserved;
+    buf_ = new_buf;
+    cur_ = new_cur;
+    top_ = new_buf + new_reserved;
+  }
+
+  // Start a new segment with room for at least `len` more bytes. An object
+  // that is still being written moves along to the new segment.
+  void add_segment(size_t len) {
+    AUTO_VAR(new_base, size());
+    size_t carry = 0;
+    if (object_start_ != kNoObject) {
+      new_base = static_cast<uoffset_t>(object_start_);
+      carry = size() - new_base;
+    }
+    // Scalars must stay aligned relative to the end of the buffer, which may
+    // leave a few bytes unused at the top of the segment.
+    size_t top_pad = new_base & (sizeof(largest_scalar_t) - 1);
+    size_t new_reserved = std::max(segment_size_, top_pad + carry + len);
+    new_reserved = (new_reserved + sizeof(largest_scalar_t) - 1) &
+                   ~(sizeof(largest_scalar_t) - 1);
+    // Reuse the smallest spare segment that is big enough, if any.
+    AUTO_VAR(best, spares_.end());
+    for (AUTO_VAR(it, spares_.begin()); it != spares_.end(); ++it) {
+      if (it->reserved >= new_reserved &&
+          (best == spares_.end() || it->reserved < best->reserved))
+        best = it;
+    }
+    uint8_t *new_buf = nullptr;
+    if (best != spares_.end()) {
+      new_buf = best->buf;
+      new_reserved = best->reserved;
+      *best = spares_.back();
+      spares_.pop_back();
+    } else {
+      new_reserved = allocator_->good_size(new_reserved);
+      new_buf = allocator_->allocate(new_reserved);
+    }
+    AUTO_VAR(new_top, new_buf + new_reserved - top_pad);
+    if (carry) memcpy(new_top - carry, cur_, carry);
+    if (buf_) {
+      Segment seg = { buf_, reserved_, top_, size_base_,
+                      static_cast<uoffset_t>(new_base - size_base_) };
+      if (seg.size) segments_.push_back(seg);
+      else spares_.push_back(seg);
+    }
+    reserved_ = new_reserved;
+    buf_ = new_buf;
+    top_ = new_top;
+    cur_ = new_top - carry;
+    size_base_ = new_base;
+  }
+
+  // Finds the segment that `offset` is in, if not the current one.
+  const Segment *find_segment(size_t offset) const {
+    // Segments cover adjacent ranges of offsets, in increasing order.
+    size_t lo = 0, hi = segments_.size() - 1;
+    while (lo < hi) {
+      AUTO_VAR(mid, (lo + hi + 1) / 2);
+      if (segments_[mid].base < offset) lo = mid;
+      else hi = mid - 1;
+    }
+    return &segments_[lo];
+  }
+
+  void free_segments() {
+    for (AUTO_VAR(it, segments_.begin()); it != segments_.end(); ++it)
+      allocator_->deallocate(it->buf, it->reserved);
+    segments_.clear();
+  }
+
+  void free_spares() {
+    for (AUTO_VAR(it, spares_.begin()); it != spares_.end(); ++it)
+      allocator_->deallocate(it->buf, it->reserved);
+    spares_.clear();
+  }
+
+  size_t initial_size_;
+  size_t segment_size_;  // 0 if not using segments.
   size_t reserved_;
   uint8_t *buf_;
   uint8_t *cur_;  // Points at location between empty (below) and used (above).
-  const simple_allocator &allocator_;
+  uint8_t *top_;  // End of the data in the current segment.
+  uoffset_t size_base_;  // Size of the data in all earlier segments.
+  size_t object_start_;  // size() at begin_object(), or kNoObject.
+  std::vector<Segment> segments_;  // Earlier segments, oldest first.
+  std::vector<Segment> spares_;  // Unused segments, only buf and reserved.
+  bool measure_only_;
+  std::vector<uint8_t> scratch_;  // Where bytes go when only measuring.
+  largest_scalar_t sink_;  // Where data_at() scalars go then.
+  bool external_;  // buf_ is owned by the caller.
+  bool overflowed_;  // external_ buffer was too small.
+  Allocator *allocator_;
+  GrowthPolicy growth_policy_;
 };
 
 // Converts a Field ID to a virtual table offset.
@@ -526,6 +1368,114 @@ inline size_t PaddingBytes(size_t buf_size, size_t scalar_size) {
   return ((~buf_size) + 1) & (scalar_size - 1);
 }
 
+// Open addressing hash index of byte sequences that have been serialized
+// into a buffer (such as vtables), mapping them to their offset.
+// A copy of each sequence is kept in a compact arena, such that lookups don't
+// have to touch the (much larger) buffer. clear() keeps all capacity around,
+// so a builder that is reused doesn't reallocate.
+class DedupIndex {
+ public:
+  DedupIndex() : count_(0) {}
+
+  void swap(DedupIndex &other) {
+    slots_.swap(other.slots_);
+    arena_.swap(other.arena_);
+    std::swap(count_, other.count_);
+  }
+
+  static uint32_t Hash(const uint8_t *bytes, size_t len) {
+    return HashFnv1a<uint32_t>(bytes, len);
+  }
+
+  // Returns the offset of an earlier sequence equal to `bytes`, or 0 if
+  // there is none. `hash` must be Hash(bytes, len).
+  uoffset_t Find(const uint8_t *bytes, size_t len, uint32_t hash) const {
+    if (!count_) return 0;
+    AUTO_VAR(mask, slots_.size() - 1);
+    for (AUTO_VAR(i, hash & mask); slots_[i].off; i = (i + 1) & mask) {
+      AUTO_VAR(&e, slots_[i]);
+      if (e.hash == hash && e.len == len &&
+          !memcmp(arena_.data() + e.arena_pos, bytes, len))
+        return e.off;
+    }
+    return 0;
+  }
+
+  // Remember `bytes` were serialized at offset `off` (which can't be 0).
+  void Insert(const uint8_t *bytes, size_t len, uint32_t hash,
+              uoffset_t off) {
+    assert(off);
+    if ((count_ + 1) * 2 > slots_.size()) Rehash();
+    AUTO_VAR(mask, slots_.size() - 1);
+    AUTO_VAR(i, hash & mask);
+    while (slots_[i].off) i = (i + 1) & mask;
+    Entry e = { hash, static_cast<uoffset_t>(len), off,
+                static_cast<uoffset_t>(arena_.size()) };
+    slots_[i] = e;
+    arena_.insert(arena_.end(), bytes, bytes + len);
+    count_++;
+  }
+
+  size_t size() const { return count_; }
+
+  // Add the sequences in `other` that aren't in this index yet, with `base`
+  // added to their offsets, as long as size() stays below `max_size`.
+  void Merge(const DedupIndex &other, uoffset_t base, size_t max_size) {
+    for (AUTO_VAR(it, other.slots_.begin());
+         it != other.slots_.end() && count_ < max_size; ++it) {
+      if (!it->off) continue;
+      AUTO_VAR(bytes, other.arena_.data() + it->arena_pos);
+      if (!Find(bytes, it->len, it->hash))
+        Insert(bytes, it->len, it->hash, it->off + base);
+    }
+  }
+
+  void clear() {
+    if (count_) {
+      Entry empty = { 0, 0, 0, 0 };
+      std::fill(slots_.begin(), slots_.end(), empty);
+    }
+    arena_.clear();
+    count_ = 0;
+  }
+
+  size_t memory_usage() const {
+    return slots_.capacity() * sizeof(Entry) + arena_.capacity();
+  }
+
+  // Free all memory if more than `max_bytes` is held. Only while empty.
+  void shrink(size_t max_bytes) {
+    assert(!count_);
+    if (memory_usage() > max_bytes) DedupIndex().swap(*this);
+  }
+
+ private:
+  struct Entry {
+    uint32_t hash;
+    uoffset_t len;
+    uoffset_t off;  // 0 for an empty slot.
+    uoffset_t arena_pos;
+  };
+
+  void Rehash() {
+    std::vector<Entry> old;
+    old.swap(slots_);
+    Entry empty = { 0, 0, 0, 0 };
+    slots_.resize(std::max(old.size() * 2, static_cast<size_t>(16)), empty);
+    AUTO_VAR(mask, slots_.size() - 1);
+    for (AUTO_VAR(it, old.begin()); it != old.end(); ++it) {
+      if (!it->off) continue;
+      AUTO_VAR(i, it->hash & mask);
+      while (slots_[i].off) i = (i + 1) & mask;
+      slots_[i] = *it;
+    }
+  }
+
+  std::vector<Entry> slots_;  // Size is always 0 or a power of 2.
+  std::vector<uint8_t> arena_;
+  size_t count_;
+};
+
 // Helper class to hold data needed in creation of a flat buffer.
 // To serialize data, you typically call one of the Create*() functions in
 // the generated code, which in turn call a sequence of StartTable/PushElement/
@@ -534,21 +1484,77 @@ inline size_t PaddingBytes(size_t buf_size, size_t scalar_size) {
 // Finish() wraps up the buffer ready for transport.
 class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
  public:
+  // Memory is obtained from `allocator` if given (which must outlive the
+  // builder and any buffer released from it), otherwise from new/delete.
   explicit FlatBufferBuilder(uoffset_t initial_size = 1024,
-                             const simple_allocator *allocator = nullptr)
-      : buf_(initial_size, allocator ? *allocator : default_allocator),
-        minalign_(1), force_defaults_(false) {
+                             Allocator *allocator = nullptr)
+      : buf_(initial_size,
+             allocator ? *allocator : DefaultAllocator::instance()),
+        max_dedup_vtables_(~static_cast<size_t>(0)),
+        minalign_(1), force_defaults_(false), share_strings_(false) {
+    offsetbuf_.reserve(16);  // Avoid first few reallocs.
+    EndianCheck();
+  }
+
+  // Deprecated: as above, with an allocator derived from simple_allocator.
+  // A template, so that a null allocator still picks the constructor above.
+  template<typename A> FlatBufferBuilder(
+                         uoffset_t initial_size, const A *allocator,
+                         typename A::deprecated_simple_allocator * = nullptr)
+      : buf_(initial_size,
+             allocator ? static_cast<Allocator &>(const_cast<A &>(*allocator))
+                       : DefaultAllocator::instance()),
+        max_dedup_vtables_(~static_cast<size_t>(0)),
+        minalign_(1), force_defaults_(false), share_strings_(false) {
     offsetbuf_.reserve(16);  // Avoid first few reallocs.
-    vtables_.reserve(16);
     EndianCheck();
   }
 
+#if !defined(NO_MOVE_SEMANTICS)
+  // Takes over the state of `other`, including a buffer under construction.
+  // `other` is left empty and can be used to build a new buffer.
+  FlatBufferBuilder(FlatBufferBuilder &&other)
+      : buf_(std::move(other.buf_)),
+        max_dedup_vtables_(other.max_dedup_vtables_),
+        minalign_(1), force_defaults_(other.force_defaults_),
+        share_strings_(other.share_strings_) {
+    offsetbuf_.swap(other.offsetbuf_);
+    vtables_.swap(other.vtables_);
+    strings_.swap(other.strings_);
+    flat_.swap(other.flat_);
+    keys_.swap(other.keys_);
+    prefixes_.swap(other.prefixes_);
+    std::swap(minalign_, other.minalign_);
+  }
+
+  FlatBufferBuilder &operator=(FlatBufferBuilder &&other) {
+    Swap(other);
+    return *this;
+  }
+#endif
+
+  // Exchange all state with `other`.
+  void Swap(FlatBufferBuilder &other) {
+    buf_.swap(other.buf_);
+    offsetbuf_.swap(other.offsetbuf_);
+    vtables_.swap(other.vtables_);
+    strings_.swap(other.strings_);
+    flat_.swap(other.flat_);
+    keys_.swap(other.keys_);
+    prefixes_.swap(other.prefixes_);
+    std::swap(max_dedup_vtables_, other.max_dedup_vtables_);
+    std::swap(minalign_, other.minalign_);
+    std::swap(force_defaults_, other.force_defaults_);
+    std::swap(share_strings_, other.share_strings_);
+  }
+
   // Reset all the state in this FlatBufferBuilder so it can be reused
   // to construct another buffer.
   void Clear() {
     buf_.clear();
     offsetbuf_.clear();
     vtables_.clear();
+    strings_.clear();
     minalign_ = 1;
   }
 
@@ -556,16 +1562,129 @@ class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
   uoffset_t GetSize() const { return buf_.size(); }
 
   // Get the serialized buffer (after you call Finish()).
+  // If the buffer consists of multiple segments (see SetSegmentSize()), this
+  // only points to the first one, use GetBufferSpans() instead.
   uint8_t *GetBufferPointer() const { return buf_.data(); }
 
+  // Get the serialized buffer (after you call Finish()) as a list of
+  // contiguous spans in order, e.g. to write it with writev() without
+  // flattening it first. A single span unless SetSegmentSize() was used.
+  void GetBufferSpans(std::vector<BufferSpan> *spans) const {
+    spans->clear();
+    buf_.spans(spans);
+  }
+
+  // Copy the serialized buffer into `dest`, which must have room for
+  // GetSize() bytes. Works regardless of how many segments it consists of.
+  void FlattenBuffer(uint8_t *dest) const { buf_.copy_to(dest); }
+
 #if !defined(NO_UNIQUE_PTR)
   // Get the released pointer to the serialized buffer.
   // Don't attempt to use this FlatBufferBuilder afterwards!
+  // Not available if the buffer consists of multiple segments.
   unique_ptr_t ReleaseBufferPointer() { return buf_.release(); }
 #endif
 
+#if !defined(NO_MOVE_SEMANTICS)
+  // Take the finished buffer out of the builder, as a single block even if
+  // it consisted of multiple segments. Cheaper than ReleaseBufferPointer(),
+  // and the builder is left empty, ready to build another buffer.
+  DetachedBuffer Release() {
+    AUTO_VAR(detached, buf_.detach());
+    Clear();
+    return detached;
+  }
+#endif
+
+  // Make sure `size` more bytes can be serialized without the buffer having
+  // to grow (and copy its contents). Useful when the final size is known or
+  // can be estimated.
+  void Reserve(size_t size) { buf_.reserve(size); }
+
+  // The number of bytes the buffer can hold before it has to grow.
+  size_t GetCapacity() const { return buf_.capacity(); }
+
+  // All memory held by the builder: the buffer, and what it uses to share
+  // vtables and strings. It never goes down while building, so if it is
+  // the same before and after building a buffer, no memory was allocated.
+  size_t GetMemoryUsage() const {
+    return buf_.memory_usage() + offsetbuf_.capacity() * sizeof(FieldLoc) +
+           vtables_.memory_usage() + strings_.memory_usage() +
+           flat_.capacity() + keys_.capacity() * sizeof(uoffset_t) +
+           prefixes_.capacity() * sizeof(uint64_t);
+  }
+
+  // Clear() keeps all memory for reuse, this gives back what is beyond
+  // `max_capacity` bytes, e.g. after building an unusually big buffer:
+  // a bigger buffer is replaced by one of `max_capacity` bytes, and spare
+  // segments are freed. Only while empty (right after Clear()).
+  void Trim(size_t max_capacity) {
+    buf_.shrink(max_capacity);
+    vtables_.shrink(max_capacity);
+    strings_.shrink(max_capacity);
+    if (flat_.capacity() > max_capacity) std::vector<uint8_t>().swap(flat_);
+    if (keys_.capacity() * sizeof(uoffset_t) > max_capacity)
+      std::vector<uoffset_t>().swap(keys_);
+    if (prefixes_.capacity() * sizeof(uint64_t) > max_capacity)
+      std::vector<uint64_t>().swap(prefixes_);
+  }
+
+  // Change how much the buffer grows by when it runs out of space.
+  void SetGrowthPolicy(GrowthPolicy growth_policy) {
+    buf_.set_growth_policy(growth_policy);
+  }
+
+  // Rather than keeping the buffer in one block that is reallocated (and
+  // copied) whenever it runs out of space, add segments of at least
+  // `segment_size` bytes as needed. Data never moves once written, which
+  // saves the copying and keeps peak memory use close to the buffer size,
+  // but the finished buffer is then not contiguous in memory: use
+  // GetBufferSpans() or FlattenBuffer() to get at it. Objects (tables,
+  // vectors, strings) are never split across segments, a segment is made
+  // bigger if needed to hold one. Must be called while the builder is empty,
+  // 0 goes back to a single block.
+  void SetSegmentSize(size_t segment_size) {
+    buf_.set_segment_size(segment_size);
+  }
+
+  // Don't store anything, only compute the size the buffer would have.
+  // Building a buffer twice, first in this mode, then for real after a
+  // Reserve() of the measured GetSize(), makes the second pass allocate
+  // exactly once and never copy. Everything else (alignment, vtable and
+  // string sharing) works as usual, only Required() fields aren't checked
+  // and CreateVectorOfSortedTables() doesn't sort. Must be called while the
+  // builder is empty.
+  void MeasureOnly(bool measure_only) { buf_.set_measure_only(measure_only); }
+
+  // Build directly into `size` bytes of memory at `buf` owned by the caller
+  // (e.g. a network send buffer or shared memory), instead of allocating.
+  // The data ends up at the end of it (within 7 bytes, for alignment), see
+  // GetBufferPointer(). The builder never allocates for the buffer then: if
+  // it doesn't fit, it stops storing data and only measures (see
+  // MeasureOnly()), Overflowed() returns true, and GetSize() is the space
+  // that would have been needed (or more, for a buffer smaller than a
+  // vtable). Memory returned for you to write into, as by
+  // CreateUninitializedVector(), is then nullptr if it doesn't fit in the
+  // buffer either. Clear() starts over in the same memory, pass nullptr to
+  // go back to allocating. Must be called while empty.
+  void UseExternalBuffer(uint8_t *buf, size_t size) {
+    buf_.set_external_buffer(buf, size);
+  }
+
+  // True if the buffer given to UseExternalBuffer() was too small.
+  bool Overflowed() const { return buf_.overflowed(); }
+
   void ForceDefaults(bool fd) { force_defaults_ = fd; }
 
+  // Tables with identical vtables share a single copy of it. By default all
+  // distinct vtables are remembered for this, which costs a hash lookup per
+  // table and some memory for buffers with many different table layouts.
+  // This limits how many are remembered (tables using a vtable beyond the
+  // limit get their own copy), and 0 turns deduplication off altogether.
+  void SetMaxDedupVtables(size_t max_vtables) {
+    max_dedup_vtables_ = max_vtables;
+  }
+
   void Pad(size_t num_bytes) { buf_.fill(num_bytes); }
 
   void Align(size_t elem_size) {
@@ -651,6 +1770,7 @@ class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
   // with a sequence of AddElement calls in between.
   uoffset_t StartTable() {
     NotNested();
+    buf_.begin_object();
     return GetSize();
   }
 
@@ -661,40 +1781,48 @@ class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
     // Write the vtable offset, which is the start of any Table.
     // We fill it's value later.
     AUTO_VAR(vtableoffsetloc, PushElement<soffset_t>(0));
+    buf_.end_object();
     // Write a vtable, which consists entirely of voffset_t elements.
     // It starts with the number of offsets, followed by a type id, followed
-    // by the offsets themselves. In reverse:
-    buf_.fill(numfields * sizeof(voffset_t));
+    // by the offsets themselves. It is reserved in one go, so it is always
+    // contiguous in memory.
+    AUTO_VAR(vt_size, FieldIndexToOffset(numfields));
     AUTO_VAR(table_object_size, vtableoffsetloc) - start;
     assert(table_object_size < 0x10000);  // Vtable use 16bit offsets.
-    PushElement<voffset_t>(static_cast<voffset_t>(table_object_size));
-    PushElement<voffset_t>(FieldIndexToOffset(numfields));
+    AUTO_VAR(vt, buf_.make_space(vt_size));
+    if (!vt) {
+      // Only measuring, with an external buffer too small for even this
+      // vtable: take it to not be shared.
+      offsetbuf_.clear();
+      return vtableoffsetloc;
+    }
+    memset(vt, 0, vt_size);
+    WriteScalar<voffset_t>(vt, vt_size);
+    WriteScalar<voffset_t>(vt + sizeof(voffset_t),
+                           static_cast<voffset_t>(table_object_size));
     // Write the offsets into the table
     for (AUTO_VAR(field_location, offsetbuf_.begin());
               field_location != offsetbuf_.end();
             ++field_location) {
       voffset_t pos = static_cast<voffset_t>(vtableoffsetloc - field_location->off);
       // If this asserts, it means you've set a field twice.
-      assert(!ReadScalar<voffset_t>(buf_.data() + field_location->id));
-      WriteScalar<voffset_t>(buf_.data() + field_location->id, pos);
+      assert(!ReadScalar<voffset_t>(vt + field_location->id));
+      WriteScalar<voffset_t>(vt + field_location->id, pos);
     }
     offsetbuf_.clear();
-    voffset_t *vt1 = reinterpret_cast<voffset_t *>(buf_.data());
-    AUTO_VAR(vt1_size, ReadScalar<voffset_t>(vt1));
     AUTO_VAR(vt_use, GetSize());
     // See if we already have generated a vtable with this exact same
     // layout before. If so, make it point to the old one, remove this one.
-    for (AUTO_VAR(it, vtables_.begin()); it != vtables_.end(); ++it) {
-      voffset_t *vt2 = reinterpret_cast<voffset_t *>(buf_.data_at(*it));
-      voffset_t vt2_size = *vt2;
-      if (vt1_size != vt2_size || memcmp(vt2, vt1, vt1_size)) continue;
-      vt_use = *it;
-      buf_.pop(GetSize() - vtableoffsetloc);
-      break;
-    }
-    // If this is a new vtable, remember it.
-    if (vt_use == GetSize()) {
-      vtables_.push_back(vt_use);
+    if (max_dedup_vtables_) {
+      AUTO_VAR(hash, DedupIndex::Hash(vt, vt_size));
+      AUTO_VAR(existing, vtables_.Find(vt, vt_size, hash));
+      if (existing) {
+        vt_use = existing;
+        buf_.pop(GetSize() - vtableoffsetloc);
+      } else if (vtables_.size() < max_dedup_vtables_) {
+        // This is a new vtable, remember it.
+        vtables_.Insert(vt, vt_size, hash, vt_use);
+      }
     }
     // Fill the vtable offset we created above.
     // The offset points from the beginning of the object to where the
@@ -710,8 +1838,11 @@ class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
   // This checks a required field has been set in a given table that has
   // just been constructed.
   template<typename T> void Required(Offset<T> table, voffset_t field) {
+    if (buf_.measure_only()) return;  // Nothing to check.
+    // The vtable may be in a different segment, so find it by offset.
     AUTO_VAR(table_ptr, buf_.data_at(table.o));
-    AUTO_VAR(vtable_ptr, table_ptr) - ReadScalar<soffset_t>(table_ptr);
+    AUTO_VAR(vtable_ptr, buf_.data_at(
+      static_cast<uoffset_t>(table.o + ReadScalar<soffset_t>(table_ptr))));
     bool ok = ReadScalar<voffset_t>(vtable_ptr + field) != 0;
     // If this fails, the caller will show what field needs to be set.
     assert(ok);
@@ -720,10 +1851,14 @@ class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
 
   uoffset_t StartStruct(size_t alignment) {
     Align(alignment);
+    buf_.begin_object();
     return GetSize();
   }
 
-  uoffset_t EndStruct() { return GetSize(); }
+  uoffset_t EndStruct() {
+    buf_.end_object();
+    return GetSize();
+  }
 
   void ClearOffsets() { offsetbuf_.clear(); }
 
@@ -739,12 +1874,8 @@ class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
 
   // Functions to store strings, which are allowed to contain any binary data.
   Offset<String> CreateString(const char *str, size_t len) {
-    NotNested();
-    PreAlign<uoffset_t>(len + 1);  // Always 0-terminated.
-    buf_.fill(1);
-    PushBytes(reinterpret_cast<const uint8_t *>(str), len);
-    PushElement(static_cast<uoffset_t>(len));
-    return Offset<String>(GetSize());
+    return share_strings_ ? CreateSharedString(str, len)
+                          : SerializeString(str, len);
   }
 
   Offset<String> CreateString(const char *str) {
@@ -755,13 +1886,43 @@ class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
     return CreateString(str.c_str(), str.length());
   }
 
+  // Like CreateString, but if a string with identical contents was created
+  // with CreateSharedString before, refers to that one instead of storing
+  // another copy. Worth it for data with many repeated strings (enum-like
+  // names etc.), at the cost of a hash lookup and keeping a copy of each
+  // distinct string in the builder.
+  Offset<String> CreateSharedString(const char *str, size_t len) {
+    AUTO_VAR(bytes, reinterpret_cast<const uint8_t *>(str));
+    AUTO_VAR(hash, DedupIndex::Hash(bytes, len));
+    AUTO_VAR(existing, strings_.Find(bytes, len, hash));
+    if (existing) return Offset<String>(existing);
+    AUTO_VAR(off, SerializeString(str, len));
+    strings_.Insert(bytes, len, hash, off.o);
+    return off;
+  }
+
+  Offset<String> CreateSharedString(const char *str) {
+    return CreateSharedString(str, strlen(str));
+  }
+
+  Offset<String> CreateSharedString(const std::string &str) {
+    return CreateSharedString(str.c_str(), str.length());
+  }
+
+  // Make all CreateString calls behave like CreateSharedString, including
+  // those made by generated code or the parser.
+  void ShareStrings(bool share) { share_strings_ = share; }
+
   uoffset_t EndVector(size_t len) {
-    return PushElement(static_cast<uoffset_t>(len));
+    AUTO_VAR(off, PushElement(static_cast<uoffset_t>(len)));
+    buf_.end_object();
+    return off;
   }
 
   void StartVector(size_t len, size_t elemsize) {
     PreAlign<uoffset_t>(len * elemsize);
     PreAlign(len * elemsize, elemsize);  // Just in case elemsize > uoffset_t.
+    buf_.begin_object(len * elemsize + sizeof(uoffset_t));
   }
 
   uint8_t *ReserveElements(size_t len, size_t elemsize) {
@@ -795,27 +1956,143 @@ class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
   }
 
  private:
-  template<typename T> bool TableKeysCompare(const Offset<T> &a, const Offset<T> &b)
-  {
-    T *table_a = reinterpret_cast<T *>(buf_.data_at(a.o));
-    T *table_b = reinterpret_cast<T *>(buf_.data_at(b.o));
+  Offset<String> SerializeString(const char *str, size_t len) {
+    NotNested();
+    PreAlign<uoffset_t>(len + 1);  // Always 0-terminated.
+    buf_.begin_object();
+    buf_.fill(1);
+    PushBytes(reinterpret_cast<const uint8_t *>(str), len);
+    PushElement(static_cast<uoffset_t>(len));
+    buf_.end_object();
+    return Offset<String>(GetSize());
+  }
+
+  // `end` is the end of a contiguous copy of the buffer.
+  template<typename T> static bool TableKeysCompare(const uint8_t *end,
+                                                    const Offset<T> &a,
+                                                    const Offset<T> &b) {
+    const T *table_a = reinterpret_cast<const T *>(end - a.o);
+    const T *table_b = reinterpret_cast<const T *>(end - b.o);
     return table_a->KeyCompareLessThan(table_b);
   }
+
+  // The end of the buffer, from which offsets to tables can be resolved.
+  // If the buffer consists of multiple segments, this is the end of a
+  // copy of it in `flat`.
+  const uint8_t *ContiguousEnd(std::vector<uint8_t> *flat) const {
+    if (buf_.contiguous()) return buf_.data() + GetSize();
+    flat->resize(GetSize());
+    FlattenBuffer(flat->data());
+    return flat->data() + flat->size();
+  }
+
+  // Sort tables by their key, if already known.
+  template<typename T> void SortTables(Offset<T> *v, size_t len) {
+    if (buf_.measure_only()) return;  // Keys unknown.
+    std::sort(v, v + len, std_or_boost::bind(
+      &FlatBufferBuilder::TableKeysCompare<T>,
+      ContiguousEnd(&flat_), BIND_PLACEHOLDER(1), BIND_PLACEHOLDER(2)));
+  }
+
+  // Store `sorted` into the subtree of node `k` (at `out[k - 1]`) in order,
+  // starting at `*rank`.
+  template<typename T> static void EytzingerFill(const uoffset_t *sorted,
+                                                 size_t *rank, T *out,
+                                                 size_t k, size_t len) {
+    if (k > len) return;
+    EytzingerFill(sorted, rank, out, 2 * k, len);
+    out[k - 1] = sorted[(*rank)++];
+    EytzingerFill(sorted, rank, out, 2 * k + 1, len);
+  }
  public:
+  // If the buffer consists of multiple segments (see SetSegmentSize()), keys
+  // may refer to data in any of them, so this sorts using a temporary
+  // contiguous copy of the buffer.
   template<typename T> Offset<Vector<Offset<T> > > CreateVectorOfSortedTables(
                                                      Offset<T> *v, size_t len) {
-    std::sort(v, v + len, std_or_boost::bind(&FlatBufferBuilder::TableKeysCompare<T>,
-      this, BIND_PLACEHOLDER(2), BIND_PLACEHOLDER(3)));
+    SortTables(v, len);
     return CreateVector(v, len);
   }
 
   template<typename T> Offset<Vector<Offset<T> > > CreateVectorOfSortedTables(
-                                                            std::vector<T> *v) {
+                                                std::vector<Offset<T> > *v) {
     return CreateVectorOfSortedTables(v->data(), v->size());
   }
 
+  // Like CreateVectorOfSortedTables(), but rather than in sorted order, the
+  // tables are stored in Eytzinger order: that of a breadth first walk of a
+  // balanced binary search tree. Searching them with
+  // Vector::LookupByKeyEytzinger() touches far fewer cache lines than a
+  // binary search. Use EytzingerIndex() to find the table at a given sorted
+  // position. `v` is left in the order stored, e.g. for CreateKeyHashIndex().
+  template<typename T> Offset<Vector<Offset<T> > >
+      CreateVectorOfEytzingerTables(Offset<T> *v, size_t len) {
+    SortTables(v, len);
+    keys_.resize(len);
+    for (size_t i = 0; i < len; i++) keys_[i] = v[i].o;
+    size_t rank = 0;
+    EytzingerFill(keys_.data(), &rank, v, 1, len);
+    return CreateVector(v, len);
+  }
+
+  template<typename T> Offset<Vector<Offset<T> > >
+      CreateVectorOfEytzingerTables(std::vector<Offset<T> > *v) {
+    return CreateVectorOfEytzingerTables(v->data(), v->size());
+  }
+
+  // Create a hash index of the keys of the tables in `v`, for
+  // Vector::LookupByKey(key, hash_index). `v` must be in the order the
+  // vector of them was created in, e.g. as sorted by
+  // CreateVectorOfSortedTables(), which the vector then still needs to be
+  // for lookups without the index. The index takes 2 to 4 uoffset_t per
+  // table, and is typically stored in a field next to the vector, see
+  // the hash_index attribute in the schema.
+  template<typename T> Offset<Vector<uoffset_t> > CreateKeyHashIndex(
+                                              const Offset<T> *v, size_t len) {
+    uoffset_t slots = len ? 2 : 0;
+    while (slots < len * 2) slots *= 2;
+    keys_.assign(slots, 0);
+    if (!buf_.measure_only()) {  // Keys unknown, but the size is all we need.
+      AUTO_VAR(end, ContiguousEnd(&flat_));
+      for (size_t i = 0; i < len; i++) {
+        AUTO_VAR(table, reinterpret_cast<const T *>(end - v[i].o));
+        AUTO_VAR(slot, table->KeyHash() & (slots - 1));
+        while (keys_[slot]) slot = (slot + 1) & (slots - 1);
+        keys_[slot] = static_cast<uoffset_t>(i + 1);
+      }
+    }
+    return CreateVector(keys_);
+  }
+
+  template<typename T> Offset<Vector<uoffset_t> > CreateKeyHashIndex(
+                                          const std::vector<Offset<T> > &v) {
+    return CreateKeyHashIndex(v.data(), v.size());
+  }
+
+  // Create an array of the first 8 bytes of the (string) keys of the tables
+  // in `v`, for Vector::LookupByKeyPrefix(). Like for CreateKeyHashIndex(),
+  // `v` must be in the order the vector of them was created in. Typically
+  // stored in a field next to the vector, see the key_prefix attribute in
+  // the schema.
+  template<typename T> Offset<Vector<uint64_t> > CreateKeyPrefixes(
+                                              const Offset<T> *v, size_t len) {
+    prefixes_.assign(len, 0);
+    if (!buf_.measure_only()) {  // Keys unknown, but the size is all we need.
+      AUTO_VAR(end, ContiguousEnd(&flat_));
+      for (size_t i = 0; i < len; i++)
+        prefixes_[i] = reinterpret_cast<const T *>(end - v[i].o)->KeyPrefix();
+    }
+    return CreateVector(prefixes_);
+  }
+
+  template<typename T> Offset<Vector<uint64_t> > CreateKeyPrefixes(
+                                          const std::vector<Offset<T> > &v) {
+    return CreateKeyPrefixes(v.data(), v.size());
+  }
+
   // Specialized version for non-copying use cases. Write the data any time
-  // later to the returned buffer pointer `buf`.
+  // later to the returned buffer pointer `buf` (which may be nullptr after
+  // an external buffer overflowed, see UseExternalBuffer()).
   uoffset_t CreateUninitializedVector(size_t len, size_t elemsize,
                                       uint8_t **buf) {
     NotNested();
@@ -830,6 +2107,38 @@ class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
                                      reinterpret_cast<uint8_t **>(buf));
   }
 
+  // Copy all objects built in `child` into this buffer, e.g. to build parts
+  // of a large buffer in parallel, each in their own builder. `child` must
+  // not have been finished, and may be cleared or destroyed afterwards.
+  // Returns the base to pass to Relocate() to get the offset of an object
+  // of `child` in this buffer. The objects are copied as is, since all
+  // offsets within them are relative. Vtables and shared strings of `child`
+  // are shared with tables and strings created here afterwards (but
+  // subtrees spliced in keep the copies of the vtables they came with).
+  uoffset_t Splice(const FlatBufferBuilder &child) {
+    NotNested();
+    assert(!child.offsetbuf_.size() && !child.buf_.measure_only());
+    Align(child.minalign_);  // Keeps all of child's data aligned.
+    AUTO_VAR(base, GetSize());
+    std::vector<BufferSpan> spans;
+    child.GetBufferSpans(&spans);
+    // We're writing downwards, so the last span goes first.
+    for (AUTO_VAR(it, spans.rbegin()); it != spans.rend(); ++it) {
+      AUTO_VAR(dest, buf_.make_space(it->size));
+      if (dest) memcpy(dest, it->data, it->size);
+    }
+    vtables_.Merge(child.vtables_, base, max_dedup_vtables_);
+    strings_.Merge(child.strings_, base, ~static_cast<size_t>(0));
+    return base;
+  }
+
+  // The offset of an object of a builder spliced in with Splice(), which
+  // returned `base`.
+  template<typename T> static Offset<T> Relocate(Offset<T> child_offset,
+                                                 uoffset_t base) {
+    return Offset<T>(child_offset.o + base);
+  }
+
   static const size_t kFileIdentifierLength = 4;
 
   // Finish serializing a buffer by writing the root offset.
@@ -837,39 +2146,66 @@ class FlatBufferBuilder FLATBUFFERS_FINAL_CLASS {
   // FlatBuffers file header.
   template<typename T> void Finish(Offset<T> root,
                                    const char *file_identifier = nullptr) {
+    Finish(root.o, file_identifier, false);
+  }
+
+  // Like Finish(), but additionally prefixes the buffer with its size (as a
+  // uoffset_t, not counting the prefix itself), such that many of them can
+  // be stored or streamed back to back. The total size is a multiple of
+  // sizeof(largest_scalar_t), which keeps such sequences aligned.
+  // Read with GetSizePrefixedRoot() / Verifier::VerifySizePrefixedBuffer().
+  template<typename T> void FinishSizePrefixed(Offset<T> root,
+                                      const char *file_identifier = nullptr) {
+    Finish(root.o, file_identifier, true);
+  }
+
+ private:
+  // You shouldn't really be copying instances of this class.
+  FlatBufferBuilder(const FlatBufferBuilder &);
+  FlatBufferBuilder &operator=(const FlatBufferBuilder &);
+
+  void Finish(uoffset_t root, const char *file_identifier, bool size_prefix) {
+    if (size_prefix && minalign_ < sizeof(largest_scalar_t))
+      minalign_ = sizeof(largest_scalar_t);
     // This will cause the whole buffer to be aligned.
-    PreAlign(sizeof(uoffset_t) + (file_identifier ? kFileIdentifierLength : 0),
+    PreAlign(sizeof(uoffset_t) * (size_prefix ? 2 : 1) +
+               (file_identifier ? kFileIdentifierLength : 0),
              minalign_);
     if (file_identifier) {
       assert(strlen(file_identifier) == kFileIdentifierLength);
       buf_.push(reinterpret_cast<const uint8_t *>(file_identifier),
                 kFileIdentifierLength);
     }
-    PushElement(ReferTo(root.o));  // Location of root.
+    PushElement(ReferTo(root));  // Location of root.
+    if (size_prefix) PushElement(GetSize());
   }
 
- private:
-  // You shouldn't really be copying instances of this class.
-  FlatBufferBuilder(const FlatBufferBuilder &);
-  FlatBufferBuilder &operator=(const FlatBufferBuilder &);
-
   struct FieldLoc {
     uoffset_t off;
     voffset_t id;
   };
 
-  simple_allocator default_allocator;
-
   vector_downward buf_;
 
   // Accumulating offsets of table members while it is being built.
   std::vector<FieldLoc> offsetbuf_;
 
-  std::vector<uoffset_t> vtables_;  // todo: Could make this into a map?
+  DedupIndex vtables_;  // Vtables written so far, for deduplication.
+  DedupIndex strings_;  // Strings created with CreateSharedString.
+
+  // Scratch space of the helpers for vectors of tables with keys, kept like
+  // the buffer itself, so that they don't allocate once warmed up.
+  std::vector<uint8_t> flat_;  // Contiguous copy of a segmented buffer.
+  std::vector<uoffset_t> keys_;  // Sorted offsets, or a hash index.
+  std::vector<uint64_t> prefixes_;
+
+  size_t max_dedup_vtables_;
 
   size_t minalign_;
 
   bool force_defaults_;  // Serialize values equal to their defaults anyway.
+
+  bool share_strings_;  // CreateString acts like CreateSharedString.
 };
 
 // Helper to get a typed pointer to the root object contained in the buffer.
@@ -879,20 +2215,188 @@ template<typename T> const T *GetRoot(const void *buf) {
     EndianScalar(*reinterpret_cast<const uoffset_t *>(buf)));
 }
 
+// Like GetRoot(), for a buffer finished with FinishSizePrefixed().
+template<typename T> const T *GetSizePrefixedRoot(const void *buf) {
+  return GetRoot<T>(reinterpret_cast<const uint8_t *>(buf) +
+                    sizeof(uoffset_t));
+}
+
+// The size of a buffer finished with FinishSizePrefixed(), not counting the
+// size prefix itself.
+inline uoffset_t GetPrefixedSize(const void *buf) {
+  return ReadScalar<uoffset_t>(buf);
+}
+
 // Helper to see if the identifier in a buffer has the expected value.
 inline bool BufferHasIdentifier(const void *buf, const char *identifier) {
   return strncmp(reinterpret_cast<const char *>(buf) + sizeof(uoffset_t),
                  identifier, FlatBufferBuilder::kFileIdentifierLength) == 0;
 }
 
+// The number of bytes at the start of the `len` at `s` that are ASCII. Looks
+// at 16 bytes at a time with SSE2 or NEON, and at 8 at a time otherwise.
+inline size_t ASCIIPrefixLength(const uint8_t *s, size_t len) {
+  size_t i = 0;
+  #if defined(FLATBUFFERS_SSE2)
+    for (; i + 16 <= len; i += 16) {
+      AUTO_VAR(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i)));
+      if (_mm_movemask_epi8(v)) break;
+    }
+  #elif defined(FLATBUFFERS_NEON)
+    for (; i + 16 <= len; i += 16) {
+      if (vmaxvq_u8(vld1q_u8(s + i)) >= 0x80) break;
+    }
+  #endif
+  for (; i + 8 <= len; i += 8) {
+    uint64_t word;
+    memcpy(&word, s + i, sizeof(word));
+    if (word & 0x8080808080808080ULL) break;
+  }
+  while (i < len && s[i] < 0x80) i++;
+  return i;
+}
+
+// Decodes the UTF-8 sequence of 2 to 4 bytes at `s` (of which `len` may be
+// read). Returns its length, and sets `*ucc` to the code point, or returns
+// 0 if `s` starts with ASCII or isn't valid UTF-8 (RFC 3629): cut short, an
+// overlong encoding, a surrogate, or past U+10FFFF. Unlike FromUTF8() (in
+// util.h), which decodes any sequence of the right shape.
+inline size_t DecodeUTF8Sequence(const uint8_t *s, size_t len,
+                                 uint32_t *ucc) {
+  uint32_t c = s[0];
+  size_t n;
+  uint32_t min;
+  if (c >= 0xC2 && c <= 0xDF) {
+    n = 2;
+    c &= 0x1F;
+    min = 0x80;
+  } else if (c >= 0xE0 && c <= 0xEF) {
+    n = 3;
+    c &= 0x0F;
+    min = 0x800;
+  } else if (c >= 0xF0 && c <= 0xF4) {
+    n = 4;
+    c &= 0x07;
+    min = 0x10000;
+  } else {
+    return 0;
+  }
+  if (n > len) return 0;
+  for (size_t i = 1; i < n; i++) {
+    if ((s[i] & 0xC0) != 0x80) return 0;
+    c = (c << 6) | (s[i] & 0x3F);
+  }
+  if (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) return 0;
+  *ucc = c;
+  return n;
+}
+
+// The number of bytes at the start of the `len` at `s` that are valid UTF-8.
+// Runs of ASCII are skipped with ASCIIPrefixLength(), and the sequences
+// in between checked with DecodeUTF8Sequence().
+inline size_t ValidUTF8Length(const uint8_t *s, size_t len) {
+  size_t i = 0;
+  for (;;) {
+    i += ASCIIPrefixLength(s + i, len - i);
+    // Text that isn't mostly ASCII tends to have runs of sequences.
+    while (i < len && s[i] >= 0x80) {
+      uint32_t ucc;
+      AUTO_VAR(n, DecodeUTF8Sequence(s + i, len - i, &ucc));
+      if (!n) return i;
+      i += n;
+    }
+    if (i == len) return i;
+  }
+}
+
+inline bool IsValidUTF8(const uint8_t *s, size_t len) {
+  return ValidUTF8Length(s, len) == len;
+}
+
+// Runs tasks on multiple threads, such that Verifier can verify parts of a
+// big vector of tables in parallel (see Verifier::SetParallel()).
+// flatbuffers/thread_pool.h has an implementation.
+class ParallelRunner {
+ public:
+  virtual ~ParallelRunner() {}
+
+  // Number of tasks that can run at the same time.
+  virtual size_t concurrency() const = 0;
+
+  // Call task(context, i) for every i < count, spread over threads, and
+  // return once all of them have returned.
+  virtual void Run(void (*task)(void *context, size_t i), void *context,
+                   size_t count) = 0;
+};
+
+// What a Verifier did, and where it first failed, if it did. Pass one to
+// Verifier::SetStats() to have it filled in. It adds up everything verified
+// until it is reset by you. Keeping track of this costs time, even when not
+// asked for, so it is only available when compiled with
+// FLATBUFFERS_VERIFIER_STATS defined.
+struct VerifierStats {
+  VerifierStats()
+    : tables(0), max_depth(0), vectors(0), bytes(0), nanoseconds(0),
+      failed(false), failure_offset(0) {}
+
+  // Add what `other` counted, and its failure if there is none here yet.
+  void Add(const VerifierStats &other) {
+    tables += other.tables;
+    max_depth = std::max(max_depth, other.max_depth);
+    vectors += other.vectors;
+    bytes += other.bytes;
+    nanoseconds += other.nanoseconds;
+    if (!failed && other.failed) {
+      failed = true;
+      failure_offset = other.failure_offset;
+      failure_path = other.failure_path;
+    }
+  }
+
+  size_t tables;         // Tables visited.
+  size_t max_depth;      // Deepest nesting of tables reached.
+  size_t vectors;        // Vectors and strings, checked to fit the buffer.
+  size_t bytes;          // Checked to be within the buffer (of all of it).
+  uint64_t nanoseconds;  // Spent in Verifier::VerifyBuffer().
+  bool failed;
+  // From the start of the buffer, of what didn't check out (this may lie
+  // outside the buffer, for an offset pointing there).
+  ptrdiff_t failure_offset;
+  // How it was reached from the root table, e.g. "enemy.inventory" or
+  // "testarrayoftables[3].name". Field names come from generated code.
+  std::string failure_path;
+};
+
+#ifdef FLATBUFFERS_VERIFIER_STATS
+  #define FLATBUFFERS_VERIFIER_STAT(x) if (stats_) { x; }
+#else
+  #define FLATBUFFERS_VERIFIER_STAT(x)
+#endif
+
 // Helper class to verify the integrity of a FlatBuffer
 class Verifier FLATBUFFERS_FINAL_CLASS {
   public:
   Verifier(const uint8_t *buf, size_t buf_len, size_t _max_depth = 64,
            size_t _max_tables = 1000000)
     : buf_(buf), end_(buf + buf_len), depth_(0), max_depth_(_max_depth),
-      num_tables_(0), max_tables_(_max_tables)
-    {}
+      num_tables_(0), max_tables_(_max_tables), failed_(false), epoch_(0),
+      memoize_(true), parallel_(nullptr), parallel_min_size_(0),
+      stats_(nullptr), utf8_(false) {
+    memset(vtables_, 0, sizeof(vtables_));
+    memset(verified_, 0, sizeof(verified_));
+  }
+
+  // Start over on another buffer, keeping the limits and settings, and
+  // any memory allocated, so verifying many buffers one after the other
+  // doesn't cost more than needed. See also BatchVerifier.
+  void Reset(const uint8_t *buf, size_t buf_len) {
+    buf_ = buf;
+    end_ = buf + buf_len;
+    depth_ = 0;
+    num_tables_ = 0;
+    failed_ = false;
+    ForgetVerified();
+  }
 
   // Central location where any verification failures register.
   bool Check(bool ok) const {
@@ -902,9 +2406,37 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
     return ok;
   }
 
+  #ifdef FLATBUFFERS_VERIFIER_STATS
+  // Have what's verified from now on counted in `stats` (or not, if null),
+  // and where it fails.
+  void SetStats(VerifierStats *stats) { stats_ = stats; }
+  #endif
+
+  // Note `at` as where verification failed (see SetStats()). Returns false.
+  bool Fail(const void *at) const {
+    #ifdef FLATBUFFERS_VERIFIER_STATS
+      if (stats_ && !stats_->failed) NoteFailure(at);
+    #else
+      (void)at;
+    #endif
+    return false;
+  }
+
+  // Called by generated code with the result of verifying each field, to
+  // trace where verification failed (see SetStats()).
+  bool Field(const char *name, bool ok) const {
+    #ifdef FLATBUFFERS_VERIFIER_STATS
+      if (!ok && stats_) AddToPath(name);
+    #else
+      (void)name;
+    #endif
+    return ok;
+  }
+
   // Verify any range within the buffer.
   bool Verify(const void *elem, size_t elem_len) const {
-    return Check(elem >= buf_ && elem <= end_ - elem_len);
+    FLATBUFFERS_VERIFIER_STAT(stats_->bytes += elem_len);
+    return Check(elem >= buf_ && elem <= end_ - elem_len) || Fail(elem);
   }
 
   // Verify a range indicated by sizeof(T).
@@ -913,16 +2445,21 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
   }
 
   // Verify a pointer (may be NULL) of a table type.
+  // Tables referred to more than once (see FlatBufferBuilder::ReferTo() and
+  // DedupIndex) are only verified the first time.
   template<typename T> bool VerifyTable(const T *table) {
-    return !table || table->Verify(*this);
+    if (!table || IsVerified(table, TypeKey<T>())) return true;
+    if (!table->Verify(*this)) return false;
+    SetVerified(table, TypeKey<T>());
+    return true;
   }
 
   // Verify a pointer (may be NULL) of any vector type.
   template<typename T> bool Verify(const Vector<T> *vec) const {
     const uint8_t *end;
     return !vec ||
-           VerifyVector(reinterpret_cast<const uint8_t *>(vec), sizeof(T),
-                        &end);
+           VerifyVector(reinterpret_cast<const uint8_t *>(vec),
+                        IndirectHelper<T>::element_stride, &end);
   }
 
   // Verify a pointer (may be NULL) to string.
@@ -931,7 +2468,19 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
     return !str ||
            (VerifyVector(reinterpret_cast<const uint8_t *>(str), 1, &end) &&
             Verify(end, 1) &&      // Must have terminator
-            Check(*end == '\0'));  // Terminating byte must be 0.
+            (Check(*end == '\0') || Fail(end)) &&  // Terminating byte is 0.
+            (!utf8_ || VerifyUTF8(str->Data(), str->size())));
+  }
+
+  // Have strings verified to be valid UTF-8 as well (see ValidUTF8Length()),
+  // which costs time proportional to their length, rather than just their
+  // bounds. Off by default.
+  void SetVerifyUTF8(bool verify) { utf8_ = verify; }
+
+  // Verify `len` bytes of string contents at `s` are valid UTF-8.
+  bool VerifyUTF8(const uint8_t *s, size_t len) const {
+    AUTO_VAR(valid, ValidUTF8Length(s, len));
+    return Check(valid == len) || Fail(s + valid);
   }
 
   // Common code between vectors and strings.
@@ -944,35 +2493,137 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
     AUTO_VAR(size, ReadScalar<uoffset_t>(vec));
     size_t byte_size = sizeof(size) + elem_size * size;
     *end = vec + byte_size;
+    FLATBUFFERS_VERIFIER_STAT(stats_->vectors++);
     return Verify(vec, byte_size);
   }
 
   // Special case for string contents, after the above has been called.
   bool VerifyVectorOfStrings(const Vector<Offset<String> > *vec) const {
-      if (vec) {
-        for (uoffset_t i = 0; i < vec->size(); i++) {
-          if (!Verify(vec->Get(i))) return false;
-        }
+      if (!vec || IsVerified(vec, TypeKey<Vector<Offset<String> > >()))
+        return true;
+      for (uoffset_t i = 0; i < vec->size(); i++) {
+        if (!Verify(vec->Get(i))) return FailedElement(i);
       }
+      SetVerified(vec, TypeKey<Vector<Offset<String> > >());
       return true;
   }
 
   // Special case for table contents, after the above has been called.
   template<typename T> bool VerifyVectorOfTables(const Vector<Offset<T> > *vec) {
-    if (vec) {
-      for (uoffset_t i = 0; i < vec->size(); i++) {
-        if (!vec->Get(i)->Verify(*this)) return false;
-      }
-    }
+    if (!vec || IsVerified(vec, TypeKey<Vector<Offset<T> > >())) return true;
+    if (!(parallel_ && vec->size() >= parallel_min_size_
+            ? VerifyTablesInParallel(vec)
+            : VerifyTablesInOrder(vec)))
+      return false;
+    SetVerified(vec, TypeKey<Vector<Offset<T> > >());
+    return true;
+  }
+
+  // Verify vectors of at least `min_size` tables in parts, on the threads
+  // of `runner`, each part (including all it refers to) with its own copy
+  // of this verifier. The tables they count are added up against the same
+  // max_tables. The parts can't know what the others verified, so they
+  // don't remember anything as verified (see VerifyTable()): tables referred
+  // to more than once are verified, and counted, each time. That only ever
+  // fails more, so where it fails the vector is verified again,
+  // sequentially. VerifyBuffer() does the same for the buffer as a whole,
+  // so its outcome is always that of verifying sequentially, though
+  // num_tables() may be higher. Vectors within the parts are verified
+  // sequentially.
+  void SetParallel(ParallelRunner *runner, uoffset_t min_size = 4096) {
+    parallel_ = runner;
+    parallel_min_size_ = std::max(min_size, static_cast<uoffset_t>(1));
+  }
+
+  // Verify a vtable, all of it. Tables tend to share a few vtables, of
+  // which the most recent ones are remembered, to not check them again.
+  bool VerifyVTable(const uint8_t *vtable) {
+    AUTO_VAR(&cached, vtables_[(reinterpret_cast<size_t>(vtable) >> 1) &
+                               (kVTableCacheSize - 1)]);
+    if (cached == vtable) return true;
+    if (!Verify<voffset_t>(vtable) ||
+        !Verify(vtable, ReadScalar<voffset_t>(vtable)))
+      return false;
+    cached = vtable;
     return true;
   }
 
   // Verify this whole buffer, starting with root type T.
   template<typename T> bool VerifyBuffer() {
-    // Call T::Verify, which must be in the generated code for this type.
-    return Verify<uoffset_t>(buf_) &&
-      reinterpret_cast<const T *>(buf_ + ReadScalar<uoffset_t>(buf_))->
-        Verify(*this);
+    return VerifyBufferWith(GeneratedRoot<T>());
+  }
+
+  // Verify this whole buffer, calling verify_root(*this, root) to verify
+  // the root table, for root types only known at runtime (see
+  // SchemaVerifier in idl.h).
+  template<typename F> bool VerifyBufferWith(F verify_root) {
+    #ifdef FLATBUFFERS_VERIFIER_STATS
+      if (stats_) {
+        AUTO_VAR(start, std::chrono::steady_clock::now());
+        bool ok = VerifyRoot(verify_root);
+        stats_->nanoseconds += static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        return ok;
+      }
+    #endif
+    return VerifyRoot(verify_root);
+  }
+
+  // Verify a buffer finished with FinishSizePrefixed(). Everything it
+  // refers to must lie within the size given by the prefix.
+  template<typename T> bool VerifySizePrefixedBuffer() {
+    return VerifySizePrefixedBufferWith(GeneratedRoot<T>());
+  }
+
+  // VerifySizePrefixedBuffer() with a root verifier as for
+  // VerifyBufferWith().
+  template<typename F> bool VerifySizePrefixedBufferWith(F verify_root) {
+    if (!Verify<uoffset_t>(buf_)) return false;
+    AUTO_VAR(size, ReadScalar<uoffset_t>(buf_));
+    if (!Check(size <= static_cast<size_t>(end_ - buf_) - sizeof(uoffset_t)))
+      return false;
+    AUTO_VAR(buf, buf_);
+    AUTO_VAR(end, end_);
+    buf_ += sizeof(uoffset_t);
+    end_ = buf_ + size;
+    ForgetVerified();  // What was checked before may be out of range now.
+    #ifdef FLATBUFFERS_VERIFIER_STATS
+      AUTO_VAR(failed, stats_ && stats_->failed);
+    #endif
+    bool ok = VerifyBufferWith(verify_root);
+    #ifdef FLATBUFFERS_VERIFIER_STATS
+      // Report failures from the start of the buffer, prefix included.
+      if (stats_ && !failed && stats_->failed)
+        stats_->failure_offset += sizeof(uoffset_t);
+    #endif
+    buf_ = buf;
+    end_ = end;
+    return ok;
+  }
+
+  // Verify a buffer of `len` bytes at `buf`, nested in this one (see the
+  // nested_flatbuffer attribute), with verify_root as for VerifyBufferWith().
+  // It is verified on its own, as if it were the whole buffer, but with its
+  // tables nested at the current depth, and counted with those here.
+  template<typename F> bool VerifyNestedBuffer(const uint8_t *buf, size_t len,
+                                               F verify_root) {
+    Verifier nested(buf, len, max_depth_, max_tables_);
+    nested.depth_ = depth_;
+    nested.num_tables_ = num_tables_;
+    nested.stats_ = stats_;
+    nested.utf8_ = utf8_;
+    #ifdef FLATBUFFERS_VERIFIER_STATS
+      AUTO_VAR(failed, stats_ && stats_->failed);
+    #endif
+    bool ok = nested.VerifyRoot(verify_root);
+    #ifdef FLATBUFFERS_VERIFIER_STATS
+      // Report failures from the start of the outer buffer.
+      if (stats_ && !failed && stats_->failed)
+        stats_->failure_offset += buf - buf_;
+    #endif
+    num_tables_ = nested.num_tables_;
+    return ok;
   }
 
   // Called at the start of a table to increase counters measuring data
@@ -982,6 +2633,9 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
   bool VerifyComplexity() {
     depth_++;
     num_tables_++;
+    FLATBUFFERS_VERIFIER_STAT(
+      stats_->tables++;
+      stats_->max_depth = std::max(stats_->max_depth, depth_));
     return Check(depth_ <= max_depth_ && num_tables_ <= max_tables_);
   }
 
@@ -991,13 +2645,443 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
     return true;
   }
 
+  // Checked access: rather than verifying the whole buffer up front, verify
+  // only what is read, as it is read. Start with GetRoot(), then read
+  // fields with the generated accessors that take a Verifier, e.g.
+  // monster->name(verifier), and vector elements with Get(). Each table
+  // has its vtable checked when it is reached, and each vector or string
+  // its length and bounds. Anything that doesn't check out reads as if it
+  // wasn't there (a default value or null), and makes ok() return false.
+  // Tables reached count towards the table limit given to the
+  // constructor, which bounds the work done on a buffer that loops back
+  // on itself. There is no recursion to bound the depth of.
+  // Only use the checked accessors on tables obtained through them.
+
+  // The root table of the buffer, or null if it doesn't check out.
+  template<typename T> const T *GetRoot() {
+    if (!Verify<uoffset_t>(buf_)) return CheckFailed<const T *>();
+    AUTO_VAR(table, reinterpret_cast<const T *>(
+                      buf_ + ReadScalar<uoffset_t>(buf_)));
+    return VerifyObject(table) ? table : CheckFailed<const T *>();
+  }
+
+  // Scalar field of a checked table.
+  template<typename T> T GetField(const void *table, voffset_t field,
+                                  T defaultval) {
+    AUTO_VAR(p, FieldData(table, field));
+    if (!p) return defaultval;
+    return Verify<T>(p) ? ReadScalar<T>(p) : CheckFailed(defaultval);
+  }
+
+  // Struct field of a checked table.
+  template<typename P> P GetStruct(const void *table, voffset_t field) {
+    AUTO_VAR(p, FieldData(table, field));
+    if (!p) return nullptr;
+    return Verify(p, sizeof(*P())) ? reinterpret_cast<P>(p)
+                                   : CheckFailed<P>();
+  }
+
+  // Table, vector, string or union field of a checked table.
+  template<typename P> P GetPointer(const void *table, voffset_t field) {
+    AUTO_VAR(p, FieldData(table, field));
+    if (!p) return nullptr;
+    if (!Verify<uoffset_t>(p)) return CheckFailed<P>();
+    AUTO_VAR(object, reinterpret_cast<P>(p + ReadScalar<uoffset_t>(p)));
+    return VerifyObject(object) ? object : CheckFailed<P>();
+  }
+
+  // Element `i` of a checked vector (of scalars or structs).
+  template<typename T> typename Vector<T>::return_type Get(
+                                            const Vector<T> *vec, uoffset_t i) {
+    if (!vec || i >= vec->size())
+      return CheckFailed<typename Vector<T>::return_type>();
+    return vec->Get(i);
+  }
+
+  // Element `i` of a checked vector of tables or strings, which is checked
+  // in turn.
+  template<typename T> const T *Get(const Vector<Offset<T> > *vec,
+                                    uoffset_t i) {
+    if (!vec || i >= vec->size()) return CheckFailed<const T *>();
+    AUTO_VAR(object, vec->Get(i));
+    return VerifyObject(object) ? object : CheckFailed<const T *>();
+  }
+
+  // False if any checked access failed.
+  bool ok() const { return !failed_; }
+
+  // Number of tables checked (or verified) so far.
+  size_t num_tables() const { return num_tables_; }
+
+  // Whether `object` was recently verified as the type identified by
+  // `type` (any address unique to that type), and can be skipped. Used
+  // by VerifyTable() and friends, and verifiers of types only known at
+  // runtime, which call SetVerified() once they have verified an object.
+  bool IsVerified(const void *object, const void *type) const {
+    AUTO_VAR(&v, VerifiedSlot(object));
+    return memoize_ && v.object == object && v.type == type &&
+           v.epoch == epoch_;
+  }
+
+  void SetVerified(const void *object, const void *type) const {
+    if (!memoize_) return;
+    Verified v = { object, type, epoch_ };
+    VerifiedSlot(object) = v;
+  }
+
+  // Remember up to `size` (rounded up to a power of 2) recently verified
+  // objects, rather than the 16 remembered by default, for buffers where
+  // many objects are referred to from far apart. Allocates the space for
+  // them; a size of 16 or less frees it again.
+  void SetMemoize(size_t size) {
+    size_t slots = kVerifiedCacheSize;
+    while (slots < size) slots *= 2;
+    Verified empty = { nullptr, nullptr, 0 };
+    std::vector<Verified>(slots > kVerifiedCacheSize ? slots : 0, empty).
+      swap(memo_);
+  }
+
+  // Called with the index of a vector element that failed to verify, to
+  // trace where verification failed (see SetStats()). Returns false.
+  bool FailedElement(uoffset_t i) const {
+    #ifdef FLATBUFFERS_VERIFIER_STATS
+      if (stats_) AddIndexToPath(i);
+    #else
+      (void)i;
+    #endif
+    return false;
+  }
+
  private:
+  // Objects (tables, vectors of tables or strings) verified recently,
+  // together with the type they were verified as: the same bytes read as a
+  // different type could still be out of bounds. A small direct mapped
+  // cache, kept inline so a verifier used once doesn't allocate: cheap
+  // enough to not slow down verifying trees, while objects that are
+  // referred to over and over again typically stay in it.
+  struct Verified {
+    const void *object;
+    const void *type;
+    size_t epoch;  // Of ForgetVerified() calls.
+  };
+
+  // Calls T::Verify, which must be in the generated code for this type.
+  template<typename T> struct GeneratedRoot {
+    bool operator()(Verifier &verifier, const uint8_t *root) const {
+      return reinterpret_cast<const T *>(root)->Verify(verifier);
+    }
+  };
+
+  template<typename F> bool VerifyRoot(F &verify_root) {
+    if (parallel_) return VerifyRootInParallel(verify_root);
+    return Verify<uoffset_t>(buf_) &&
+           verify_root(*this, buf_ + ReadScalar<uoffset_t>(buf_));
+  }
+
+  // See SetParallel(): without remembering what was verified, and if that
+  // fails, sequentially, starting over.
+  template<typename F> bool VerifyRootInParallel(F &verify_root) {
+    AUTO_VAR(depth, depth_);
+    AUTO_VAR(num_tables, num_tables_);
+    #ifdef FLATBUFFERS_VERIFIER_STATS
+      VerifierStats stats;
+      if (stats_) stats = *stats_;
+    #endif
+    memoize_ = false;
+    bool ok = Verify<uoffset_t>(buf_) &&
+              verify_root(*this, buf_ + ReadScalar<uoffset_t>(buf_));
+    memoize_ = true;
+    if (ok) return true;
+    depth_ = depth;
+    num_tables_ = num_tables;
+    #ifdef FLATBUFFERS_VERIFIER_STATS
+      if (stats_) *stats_ = stats;
+    #endif
+    AUTO_VAR(parallel, parallel_);
+    parallel_ = nullptr;
+    ok = VerifyRoot(verify_root);
+    parallel_ = parallel;
+    return ok;
+  }
+
+  #ifdef FLATBUFFERS_VERIFIER_STATS
+  FLATBUFFERS_NOINLINE void NoteFailure(const void *at) const {
+    stats_->failed = true;
+    stats_->failure_offset = reinterpret_cast<const uint8_t *>(at) - buf_;
+  }
+
+  // Put `part` in front of the failure path, as verification returns from
+  // where it failed.
+  FLATBUFFERS_NOINLINE void AddToPath(const char *part) const {
+    AUTO_VAR(&path, stats_->failure_path);
+    path = part + std::string(path.empty() || path[0] == '[' ? "" : ".") +
+           path;
+  }
+
+  FLATBUFFERS_NOINLINE void AddIndexToPath(uoffset_t i) const {
+    std::string index = "]";
+    do {
+      index.insert(index.begin(), static_cast<char>('0' + i % 10));
+      i /= 10;
+    } while (i);
+    AddToPath(("[" + index).c_str());
+  }
+  #endif
+
+  // A unique address for each type.
+  template<typename T> static const void *TypeKey() {
+    static const char key = 0;
+    return &key;
+  }
+
+  Verified &VerifiedSlot(const void *object) const {
+    AUTO_VAR(hash, reinterpret_cast<size_t>(object) >> 2);
+    return memo_.empty() ? verified_[hash & (kVerifiedCacheSize - 1)]
+                         : memo_[hash & (memo_.size() - 1)];
+  }
+
+  template<typename T> struct ParallelParts {
+    const Vector<Offset<T> > *vec;
+    uoffset_t part_size;
+    std::vector<Verifier> verifiers;
+    std::vector<uint8_t> ok;
+  };
+
+  template<typename T> static void VerifyPart(void *context, size_t i) {
+    AUTO_VAR(parts, static_cast<ParallelParts<T> *>(context));
+    AUTO_VAR(&verifier, parts->verifiers[i]);
+    AUTO_VAR(begin, static_cast<uoffset_t>(i) * parts->part_size);
+    AUTO_VAR(end, std::min(begin + parts->part_size, parts->vec->size()));
+    for (AUTO_VAR(j, begin); j < end; j++) {
+      if (!verifier.VerifyTable(parts->vec->Get(j))) {
+        verifier.FailedElement(j);
+        return;
+      }
+    }
+    parts->ok[i] = 1;
+  }
+
+  template<typename T> bool VerifyTablesInParallel(
+                                              const Vector<Offset<T> > *vec) {
+    // A few parts per thread, to even out differences between them.
+    AUTO_VAR(max_parts, std::max(parallel_->concurrency() * 4,
+                                 static_cast<size_t>(1)));
+    AUTO_VAR(size, vec->size());
+    ParallelParts<T> parts;
+    parts.vec = vec;
+    parts.part_size = static_cast<uoffset_t>((size + max_parts - 1) /
+                                             max_parts);
+    AUTO_VAR(count, (size + parts.part_size - 1) / parts.part_size);
+    // Each part may use all of what's left of the table budget.
+    Verifier part(*this);
+    part.parallel_ = nullptr;
+    part.num_tables_ = 0;
+    part.max_tables_ = max_tables_ - std::min(num_tables_, max_tables_);
+    part.memoize_ = false;  // See SetParallel().
+    std::vector<Verified>().swap(part.memo_);
+    parts.verifiers.resize(count, part);
+    parts.ok.resize(count, 0);
+    // Each part counts in its own stats, added up in order below.
+    std::vector<VerifierStats> stats(stats_ ? count : 0);
+    for (size_t i = 0; i < stats.size(); i++)
+      parts.verifiers[i].stats_ = &stats[i];
+    parallel_->Run(VerifyPart<T>, &parts, count);
+    bool ok = true;
+    size_t num_tables = 0;
+    for (size_t i = 0; i < count; i++) {
+      ok = ok && parts.ok[i];
+      num_tables += parts.verifiers[i].num_tables_;
+    }
+    if (memoize_ && !(ok && num_tables <= part.max_tables_)) {
+      // Maybe only for tables shared between parts, see SetParallel().
+      AUTO_VAR(parallel, parallel_);
+      parallel_ = nullptr;
+      ok = VerifyTablesInOrder(vec);
+      parallel_ = parallel;
+      return ok;
+    }
+    num_tables_ += num_tables;
+    for (size_t i = 0; i < stats.size(); i++) stats_->Add(stats[i]);
+    return Check(ok) &&
+           (Check(num_tables_ <= max_tables_) || Fail(vec));
+  }
+
+  template<typename T> bool VerifyTablesInOrder(
+                                              const Vector<Offset<T> > *vec) {
+    for (uoffset_t i = 0; i < vec->size(); i++) {
+      if (!VerifyTable(vec->Get(i))) return FailedElement(i);
+    }
+    return true;
+  }
+
+  // Rather than clearing all of verified_, move on to the next epoch.
+  void ForgetVerified() {
+    memset(vtables_, 0, sizeof(vtables_));
+    if (++epoch_) return;
+    // Wrapped around: entries from long ago could look current.
+    memset(verified_, 0, sizeof(verified_));
+    if (!memo_.empty())
+      memset(memo_.data(), 0, memo_.size() * sizeof(Verified));
+  }
+
+  template<typename T> T CheckFailed(T result = T()) {
+    Check(false);
+    failed_ = true;
+    return result;
+  }
+
+  // Where `field` of a checked table is, or null if it's not present.
+  const uint8_t *FieldData(const void *table, voffset_t field) const {
+    AUTO_VAR(t, reinterpret_cast<const uint8_t *>(table));
+    AUTO_VAR(vtable, t - ReadScalar<soffset_t>(t));
+    AUTO_VAR(vtsize, ReadScalar<voffset_t>(vtable));
+    AUTO_VAR(offset, field + sizeof(voffset_t) <= vtsize
+                       ? ReadScalar<voffset_t>(vtable + field) : 0);
+    return offset ? t + offset : nullptr;
+  }
+
+  // Check the start of a table (or union) reached, its vtable in full.
+  bool VerifyObject(const void *table) {
+    AUTO_VAR(t, reinterpret_cast<const uint8_t *>(table));
+    if (!Verify<soffset_t>(t)) return false;
+    AUTO_VAR(vtable, t - ReadScalar<soffset_t>(t));
+    return Check(++num_tables_ <= max_tables_) && VerifyVTable(vtable);
+  }
+  bool VerifyObject(const String *str) { return Verify(str); }
+  template<typename T> bool VerifyObject(const Vector<T> *vec) {
+    return Verify(vec);
+  }
+
   const uint8_t *buf_;
   const uint8_t *end_;
   size_t depth_;
   size_t max_depth_;
   size_t num_tables_;
   size_t max_tables_;
+  bool failed_;
+  size_t epoch_;
+  bool memoize_;  // Use verified_, see SetParallel().
+  static const size_t kVTableCacheSize = 16;
+  static const size_t kVerifiedCacheSize = 16;
+  const uint8_t *vtables_[kVTableCacheSize];
+  mutable Verified verified_[kVerifiedCacheSize];
+  mutable std::vector<Verified> memo_;  // Instead, if SetMemoize() is used.
+  ParallelRunner *parallel_;
+  uoffset_t parallel_min_size_;
+  VerifierStats *stats_;
+  bool utf8_;
+};
+
+// Verifies many buffers with the same root type at once, such as messages
+// as they come off the wire, reusing one Verifier for all of them (see
+// Verifier::Reset()). While one buffer is verified, the start of one a few
+// further along is prefetched, so they don't each wait on memory in turn.
+class BatchVerifier FLATBUFFERS_FINAL_CLASS {
+ public:
+  explicit BatchVerifier(size_t max_depth = 64, size_t max_tables = 1000000)
+    : verifier_(nullptr, 0, max_depth, max_tables), parallel_(nullptr),
+      parallel_min_size_(0) {}
+
+  // Verify batches of at least `min_size` buffers in parts, on the threads
+  // of `runner`, each part with its own copy of the verifier.
+  void SetParallel(ParallelRunner *runner, size_t min_size = 4096) {
+    parallel_ = runner;
+    parallel_min_size_ = min_size;
+  }
+
+  // See Verifier::SetVerifyUTF8().
+  void SetVerifyUTF8(bool verify) { verifier_.SetVerifyUTF8(verify); }
+
+  // Verify `count` buffers, the one at bufs[i] being lens[i] bytes, as
+  // Verifier::VerifyBuffer<T>() does. Sets bit i % 8 of results[i / 8] if
+  // buffer i is OK, and clears it if not (see IsOk()), as well as the
+  // bits past the last buffer. `results` must have room for
+  // (count + 7) / 8 bytes. Returns the number of buffers OK.
+  template<typename T> size_t Verify(const uint8_t *const *bufs,
+                                     const size_t *lens, size_t count,
+                                     uint8_t *results) {
+    if (count % 8) results[count / 8] &= (1 << (count % 8)) - 1;
+    if (!parallel_ || count < parallel_min_size_ || !count)
+      return VerifyRange<T>(verifier_, bufs, lens, 0, count, results);
+    // A few parts per thread, each a whole number of result bytes, so no
+    // two threads write to the same byte.
+    Parts parts;
+    parts.bufs = bufs;
+    parts.lens = lens;
+    parts.count = count;
+    parts.results = results;
+    AUTO_VAR(max_parts, std::max(parallel_->concurrency() * 4,
+                                 static_cast<size_t>(1)));
+    parts.part_size = ((count + max_parts - 1) / max_parts + 7) & ~7;
+    AUTO_VAR(num_parts, (count + parts.part_size - 1) / parts.part_size);
+    parts.verifiers.resize(num_parts, verifier_);
+    parts.num_ok.resize(num_parts, 0);
+    parallel_->Run(VerifyPart<T>, &parts, num_parts);
+    size_t num_ok = 0;
+    for (size_t i = 0; i < num_parts; i++) num_ok += parts.num_ok[i];
+    return num_ok;
+  }
+
+  // Whether buffer i was OK, according to the results of Verify().
+  static bool IsOk(const uint8_t *results, size_t i) {
+    return (results[i / 8] >> (i % 8)) & 1;
+  }
+
+ private:
+  enum {
+    kPrefetchDistance = 4,  // In buffers.
+    kPrefetchBytes = 256    // Of each buffer.
+  };
+
+  struct Parts {
+    const uint8_t *const *bufs;
+    const size_t *lens;
+    size_t count;
+    size_t part_size;
+    uint8_t *results;
+    std::vector<Verifier> verifiers;
+    std::vector<size_t> num_ok;
+  };
+
+  // The root table and its vtable are typically near the start of a buffer.
+  static void Prefetch(const uint8_t *buf, size_t len) {
+    AUTO_VAR(size, std::min(len, static_cast<size_t>(kPrefetchBytes)));
+    for (size_t i = 0; i < size; i += 64) FLATBUFFERS_PREFETCH(buf + i);
+  }
+
+  template<typename T> static size_t VerifyRange(Verifier &verifier,
+                                                 const uint8_t *const *bufs,
+                                                 const size_t *lens,
+                                                 size_t begin, size_t end,
+                                                 uint8_t *results) {
+    for (AUTO_VAR(i, begin); i < end && i < begin + kPrefetchDistance; i++)
+      Prefetch(bufs[i], lens[i]);
+    size_t num_ok = 0;
+    for (AUTO_VAR(i, begin); i < end; i++) {
+      if (static_cast<size_t>(kPrefetchDistance) < end - i)
+        Prefetch(bufs[i + kPrefetchDistance], lens[i + kPrefetchDistance]);
+      verifier.Reset(bufs[i], lens[i]);
+      AUTO_VAR(ok, static_cast<size_t>(verifier.VerifyBuffer<T>()));
+      AUTO_VAR(bit, i % 8);
+      results[i / 8] = static_cast<uint8_t>((results[i / 8] & ~(1 << bit)) |
+                                            (ok << bit));
+      num_ok += ok;
+    }
+    return num_ok;
+  }
+
+  template<typename T> static void VerifyPart(void *context, size_t i) {
+    AUTO_VAR(parts, static_cast<Parts *>(context));
+    AUTO_VAR(begin, i * parts->part_size);
+    AUTO_VAR(end, std::min(begin + parts->part_size, parts->count));
+    parts->num_ok[i] = VerifyRange<T>(parts->verifiers[i], parts->bufs,
+                                      parts->lens, begin, end,
+                                      parts->results);
+  }
+
+  Verifier verifier_;
+  ParallelRunner *parallel_;
+  size_t parallel_min_size_;
 };
 
 // "structs" are flat structures that do not have an offset table, thus
@@ -1077,9 +3161,8 @@ class Table {
     if (!verifier.Verify<soffset_t>(data_)) return false;
     AUTO_VAR(vtable, &data_[-ReadScalar<soffset_t>(data_)]);
     // Check the vtable size field, then check vtable fits in its entirety.
-    return verifier.VerifyComplexity() &&
-           verifier.Verify<voffset_t>(vtable) &&
-           verifier.Verify(vtable, ReadScalar<voffset_t>(vtable));
+    return (verifier.VerifyComplexity() || verifier.Fail(data_)) &&
+           verifier.VerifyVTable(vtable);
   }
 
   // Verify a particular field.
@@ -1096,7 +3179,7 @@ class Table {
   template<typename T> bool VerifyFieldRequired(const Verifier &verifier,
                                         voffset_t field) const {
     AUTO_VAR(field_offset, GetOptionalFieldOffset(field));
-    return verifier.Check(field_offset != 0) &&
+    return (verifier.Check(field_offset != 0) || verifier.Fail(data_)) &&
            verifier.Verify<T>(data_ + field_offset);
   }
 
@@ -1109,6 +3192,71 @@ class Table {
   uint8_t data_[1];
 };
 
+// Reads the fields of a table like Table does, but with their offsets looked
+// up in the vtable once, when pointed at the table, rather than on every
+// access. Worth it when reading several fields of the same table.
+// `NumFields` is the number of fields of the table type (as passed to
+// EndTable()). Tables with identical vtables share a single copy of it in the
+// buffer, so when pointing a view at one table after another (e.g. going
+// through a vector of them), Reset() typically finds the same vtable and
+// doesn't need to look up anything.
+// The generated code contains a view for each table type, e.g. MonsterView.
+template<voffset_t NumFields> class TableView {
+ public:
+  TableView() : data_(nullptr), vtable_(nullptr) {}
+  explicit TableView(const void *table) : data_(nullptr), vtable_(nullptr) {
+    Reset(table);
+  }
+
+  // Point at another table of the same type.
+  void Reset(const void *table) {
+    data_ = reinterpret_cast<const uint8_t *>(table);
+    AUTO_VAR(vtable, data_ - ReadScalar<soffset_t>(data_));
+    if (vtable == vtable_) return;
+    vtable_ = vtable;
+    AUTO_VAR(vtsize, ReadScalar<voffset_t>(vtable));
+    for (voffset_t i = 0; i < NumFields; i++) {
+      AUTO_VAR(field, FieldIndexToOffset(i));
+      // Fields outside the vtable (older data) are not present.
+      offsets_[i] = field < vtsize ? ReadScalar<voffset_t>(vtable + field) : 0;
+    }
+  }
+
+  // The table currently viewed.
+  const uint8_t *data() const { return data_; }
+
+  voffset_t GetOptionalFieldOffset(voffset_t field) const {
+    return offsets_[field / sizeof(voffset_t) - 2];
+  }
+
+  template<typename T> T GetField(voffset_t field, T defaultval) const {
+    AUTO_VAR(field_offset, GetOptionalFieldOffset(field));
+    return field_offset ? ReadScalar<T>(data_ + field_offset) : defaultval;
+  }
+
+  template<typename P> P GetPointer(voffset_t field) const {
+    AUTO_VAR(field_offset, GetOptionalFieldOffset(field));
+    AUTO_VAR(p, data_ + field_offset);
+    return field_offset
+      ? reinterpret_cast<P>(p + ReadScalar<uoffset_t>(p))
+      : nullptr;
+  }
+
+  template<typename P> P GetStruct(voffset_t field) const {
+    AUTO_VAR(field_offset, GetOptionalFieldOffset(field));
+    return field_offset ? reinterpret_cast<P>(data_ + field_offset) : nullptr;
+  }
+
+  bool CheckField(voffset_t field) const {
+    return GetOptionalFieldOffset(field) != 0;
+  }
+
+ private:
+  const uint8_t *data_;
+  const uint8_t *vtable_;
+  voffset_t offsets_[NumFields ? NumFields : 1];
+};
+
 // Utility function for reverse lookups on the EnumNames*() functions
 // (in the generated C++ code)
 // names must be NULL terminated.
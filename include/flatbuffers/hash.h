@@ -17,6 +17,7 @@
 #ifndef FLATBUFFERS_HASH_H_
 #define FLATBUFFERS_HASH_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 
@@ -60,6 +61,17 @@ T HashFnv1a(const char *input) {
   return hash;
 }
 
+// Variant of the above for binary data of a given length.
+template <typename T>
+T HashFnv1a(const uint8_t *input, size_t len) {
+  T hash = FnvTraits<T>::kOffsetBasis;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= input[i];
+    hash *= FnvTraits<T>::kFnvPrime;
+  }
+  return hash;
+}
+
 template <typename T>
 struct NamedHashFunction {
   const char *name;
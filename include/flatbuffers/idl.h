@@ -266,10 +266,14 @@ struct EnumDef : public Definition {
   Type underlying_type;
 };
 
+class TableKeys;
+
 class Parser {
  public:
   Parser(bool strict_json = false, bool proto_mode = false)
     : root_struct_def(nullptr),
+      buffer_(nullptr),
+      buffer_size_(0),
       source_(nullptr),
       cursor_(nullptr),
       line_(1),
@@ -286,6 +290,9 @@ class Parser {
     known_attributes_.insert("bit_flags");
     known_attributes_.insert("original_order");
     known_attributes_.insert("nested_flatbuffer");
+    known_attributes_.insert("hash_index");
+    known_attributes_.insert("eytzinger");
+    known_attributes_.insert("key_prefix");
   }
 
   ~Parser() {
@@ -332,7 +339,10 @@ class Parser {
   uoffset_t ParseTable(const StructDef &struct_def);
   void SerializeStruct(const StructDef &struct_def, const Value &val);
   void AddVector(bool sortbysize, int count);
-  uoffset_t ParseVector(const Type &type);
+  uoffset_t ParseVector(const Type &type, const FieldDef *field);
+  void CheckKeys(const TableKeys &keys, const uoffset_t *tables, size_t len);
+  void EytzingerOrder(const StructDef &struct_def, size_t count);
+  size_t AddKeyIndexes(const StructDef &struct_def, size_t fieldn);
   void ParseMetaData(Definition &def);
   bool TryTypedValue(int dtoken, bool check, Value &e, BaseType req);
   void ParseHash(Value &e, FieldDef* field);
@@ -343,6 +353,9 @@ class Parser {
   void ParseNamespace();
   StructDef &StartStruct();
   void ParseDecl();
+  void CheckIndexField(const StructDef &struct_def, const FieldDef &field,
+                       const char *attribute, BaseType element,
+                       bool string_key);
   void ParseProtoDecl();
   Type ParseTypeFromProtoType();
 
@@ -357,10 +370,30 @@ class Parser {
   std::string file_identifier_;
   std::string file_extension_;
 
+  // Have the generators (e.g. text output) work on the binary data in
+  // `buf`, rather than any data contained in the file parsed, such as a
+  // binary file mapped into memory by flatc. It is used in place, and must
+  // stay valid until the next call to this or Parse().
+  void SetBuffer(const uint8_t *buf, size_t len) {
+    builder_.Clear();
+    buffer_ = buf;
+    buffer_size_ = len;
+  }
+
+  // The data from SetBuffer(), or otherwise that contained in the file.
+  const uint8_t *GetBufferPointer() const {
+    return buffer_ ? buffer_ : builder_.GetBufferPointer();
+  }
+  size_t GetBufferSize() const {
+    return buffer_ ? buffer_size_ : builder_.GetSize();
+  }
+
   std::map<std::string, bool> included_files_;
 	std::map<std::string, std::set<std::string> > files_included_per_file_;
 
  private:
+  const uint8_t *buffer_;
+  size_t buffer_size_;
   const char *source_, *cursor_;
   int line_;  // the current line being parsed
   int token_;
@@ -376,6 +409,83 @@ class Parser {
   std::set<std::string> known_attributes_;
 };
 
+// Verifies buffers of types only known at runtime, from a parsed schema,
+// without generated code. The checks for each table type reachable from the
+// root type are compiled into a flat list once, which is then run over each
+// buffer much like the generated Verify() functions would, with the same
+// result. It also verifies the contents of nested_flatbuffer fields as their
+// own root type, which the generated code leaves to the reader.
+// Everything needed is copied out of the Parser, which needn't outlive it.
+// See idl_verifier.cpp.
+class SchemaVerifier {
+ public:
+  // Compile the checks for `root`, or the root type of the schema if null.
+  explicit SchemaVerifier(const Parser &parser,
+                          const StructDef *root = nullptr);
+
+  // Verify the whole buffer of `verifier`, as VerifyMonsterBuffer() etc. do.
+  bool VerifyBuffer(Verifier &verifier) const;
+
+  // Verify a buffer finished with FinishSizePrefixed().
+  bool VerifySizePrefixedBuffer(Verifier &verifier) const;
+
+  // Verify a table of the root type (may be NULL).
+  bool VerifyTable(Verifier &verifier, const void *table) const {
+    return VerifyTable(verifier, reinterpret_cast<const uint8_t *>(table), 0);
+  }
+
+  // False if there is no root type, or it is a struct.
+  bool ok() const { return !tables_.empty(); }
+
+ private:
+  // What to check of a field, after checking it fits the buffer.
+  enum Op {
+    kScalar,           // Nothing more (scalars and structs).
+    kString,
+    kTable,            // Of type `target`.
+    kUnion,            // Type field at `arg`, see unions_ at `target`.
+    kVector,           // Of `arg` byte scalars or structs.
+    kVectorOfStrings,
+    kVectorOfTables,   // Of type `target`.
+    kNestedBuffer      // Vector of ubyte, root type `target`.
+  };
+
+  struct FieldCheck {
+    voffset_t field;  // Offset in the vtable.
+    uint8_t op;
+    uint8_t required;
+    uint32_t size;    // Inline in the table.
+    uint32_t arg;
+    uint32_t target;
+    uint32_t name;    // In names_.
+  };
+
+  struct TableChecks {
+    uint32_t begin, end;  // In checks_.
+  };
+
+  struct CompiledRoot;
+
+  uint32_t TableIndex(const StructDef &struct_def);
+  uint32_t UnionIndex(const EnumDef &enum_def);
+  void CompileTable(const Parser &parser, const StructDef &struct_def);
+  bool VerifyTable(Verifier &verifier, const uint8_t *table,
+                   uint32_t index) const;
+  bool VerifyField(Verifier &verifier, const uint8_t *table,
+                   const uint8_t *p, const FieldCheck &check) const;
+
+  std::vector<FieldCheck> checks_;
+  std::vector<TableChecks> tables_;
+  // For each union, the number of values, followed by the table index of
+  // each value (or kNoTable).
+  std::vector<uint32_t> unions_;
+  std::vector<std::string> names_;
+  // Only used while compiling.
+  std::vector<const StructDef *> table_defs_;
+  std::map<const StructDef *, uint32_t> table_indices_;
+  std::map<const EnumDef *, uint32_t> union_indices_;
+};
+
 // Utility functions for multiple generators:
 
 extern std::string MakeCamel(const std::string &in, bool first = true);
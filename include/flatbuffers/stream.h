@@ -0,0 +1,183 @@
+/*
+ * Copyright 2015 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLATBUFFERS_STREAM_H_
+#define FLATBUFFERS_STREAM_H_
+
+#include <errno.h>
+#include <limits.h>
+
+#include "flatbuffers/flatbuffers.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+// Reading and writing sequences of size prefixed buffers (see
+// FlatBufferBuilder::FinishSizePrefixed()) from / to file descriptors,
+// such as files, pipes or sockets.
+
+namespace flatbuffers {
+
+// Writes buffers back to back to a file descriptor.
+class StreamWriter {
+ public:
+  explicit StreamWriter(int fd) : fd_(fd) {}
+
+  // Write the buffer in `fbb`, which must have been finished with
+  // FinishSizePrefixed(). Buffers made of multiple segments are written as
+  // they are, without flattening them first.
+  bool Write(const FlatBufferBuilder &fbb) {
+    fbb.GetBufferSpans(&spans_);
+    return WriteSpans(spans_.empty() ? nullptr : &spans_[0], spans_.size());
+  }
+
+  // Write a size prefixed buffer from memory.
+  bool Write(const uint8_t *buf, size_t len) {
+    BufferSpan span = { buf, len };
+    return WriteSpans(&span, 1);
+  }
+
+  // Write `count` spans, in as few system calls as possible.
+  // Returns false if the file descriptor reported an error.
+  bool WriteSpans(const BufferSpan *spans, size_t count) {
+    size_t offset = 0;  // Into spans[0], after a partial write.
+    while (count) {
+      #ifdef _WIN32
+        AUTO_VAR(written, _write(fd_, spans->data + offset,
+                                 static_cast<unsigned>(spans->size - offset)));
+      #else
+        iovec iov[kMaxIovecs];
+        size_t n = count < kMaxIovecs ? count : kMaxIovecs;
+        for (size_t i = 0; i < n; i++) {
+          AUTO_VAR(skip, i ? 0 : offset);
+          iov[i].iov_base = const_cast<uint8_t *>(spans[i].data) + skip;
+          iov[i].iov_len = spans[i].size - skip;
+        }
+        AUTO_VAR(written, writev(fd_, iov, static_cast<int>(n)));
+      #endif
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        return false;
+      }
+      // Skip over whatever was written.
+      AUTO_VAR(left, static_cast<size_t>(written));
+      while (count && left >= spans->size - offset) {
+        left -= spans->size - offset;
+        offset = 0;
+        spans++;
+        count--;
+      }
+      offset += left;
+    }
+    return true;
+  }
+
+ private:
+  #if defined(IOV_MAX) && IOV_MAX < 64
+    static const size_t kMaxIovecs = IOV_MAX;
+  #else
+    static const size_t kMaxIovecs = 64;
+  #endif
+
+  int fd_;
+  std::vector<BufferSpan> spans_;
+};
+
+// Reads size prefixed buffers from a file descriptor. They are read in large
+// chunks, and handed out in place, without copying each of them. Each
+// buffer starts at an address aligned to sizeof(largest_scalar_t), as
+// required to access it directly.
+class StreamReader {
+ public:
+  // `buffer_size` is the size of the chunks read at once, the buffer grows
+  // if a bigger one comes along. Buffers bigger than `max_size` are treated
+  // as an error, to protect against running out of memory on bad input.
+  explicit StreamReader(int fd, size_t buffer_size = 1 << 16,
+                        size_t max_size = (1UL << 31) - 1)
+    : fd_(fd), buf_(buffer_size), begin_(0), end_(0), max_size_(max_size),
+      error_(false) {}
+
+  // Get the next buffer, including its size prefix. It stays valid until
+  // the next call. Returns false at the end of the stream, or if there was
+  // an error (see error()).
+  bool Next(BufferSpan *buffer) {
+    if (!Fill(sizeof(uoffset_t))) return false;
+    size_t size = GetPrefixedSize(&buf_[begin_]);
+    if (size > max_size_ - sizeof(uoffset_t)) {
+      error_ = true;
+      return false;
+    }
+    size += sizeof(uoffset_t);
+    if (!Fill(size)) return false;
+    buffer->data = &buf_[begin_];
+    buffer->size = size;
+    begin_ += size;
+    return true;
+  }
+
+  // True if reading failed, or the stream ended halfway through a buffer.
+  bool error() const { return error_; }
+
+ private:
+  // Make sure `len` bytes are available at an aligned begin_.
+  bool Fill(size_t len) {
+    if (begin_ == end_) begin_ = end_ = 0;
+    AUTO_VAR(aligned, !(begin_ & (sizeof(largest_scalar_t) - 1)));
+    if (aligned && end_ - begin_ >= len) return true;
+    if (!aligned || begin_ + len > buf_.size()) {
+      // Move the partial data to the front, the only time we copy.
+      memmove(&buf_[0], &buf_[begin_], end_ - begin_);
+      end_ -= begin_;
+      begin_ = 0;
+      if (len > buf_.size()) buf_.resize(len);
+    }
+    while (end_ - begin_ < len) {
+      #ifdef _WIN32
+        AUTO_VAR(bytes_read, _read(fd_, &buf_[end_],
+                                   static_cast<unsigned>(buf_.size() - end_)));
+      #else
+        AUTO_VAR(bytes_read, read(fd_, &buf_[end_], buf_.size() - end_));
+      #endif
+      if (bytes_read < 0) {
+        if (errno == EINTR) continue;
+        error_ = true;
+        return false;
+      }
+      if (!bytes_read) {
+        // End of stream, which should not happen within a buffer.
+        if (end_ != begin_) error_ = true;
+        return false;
+      }
+      end_ += static_cast<size_t>(bytes_read);
+    }
+    return true;
+  }
+
+  int fd_;
+  std::vector<uint8_t> buf_;
+  size_t begin_;  // Start of the data not handed out yet.
+  size_t end_;    // End of the data read so far.
+  size_t max_size_;
+  bool error_;
+};
+
+}  // namespace flatbuffers
+
+#endif  // FLATBUFFERS_STREAM_H_
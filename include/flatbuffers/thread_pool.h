@@ -0,0 +1,134 @@
+/*
+ * Copyright 2015 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLATBUFFERS_THREAD_POOL_H_
+#define FLATBUFFERS_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "flatbuffers/flatbuffers.h"
+
+namespace flatbuffers {
+
+// A fixed set of worker threads to run tasks on, e.g. for
+// Verifier::SetParallel(). The thread calling Run() works on the tasks too,
+// so a pool of N threads starts N - 1 of them. Run() may be called from
+// multiple threads, calls are taken one at a time.
+class ThreadPool FLATBUFFERS_FINAL_CLASS : public ParallelRunner {
+ public:
+  explicit ThreadPool(size_t threads = std::thread::hardware_concurrency())
+    : task_(nullptr), context_(nullptr), count_(0), next_(0), done_(0),
+      generation_(0), busy_(0), stop_(false) {
+    for (size_t i = 1; i < threads; i++)
+      workers_.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (AUTO_VAR(it, workers_.begin()); it != workers_.end(); ++it)
+      it->join();
+  }
+
+  size_t concurrency() const OVERRIDE { return workers_.size() + 1; }
+
+  void Run(void (*task)(void *context, size_t i), void *context,
+           size_t count) OVERRIDE {
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      task_ = task;
+      context_ = context;
+      count_ = count;
+      next_ = 0;
+      done_ = 0;
+      generation_++;
+    }
+    wake_.notify_all();
+    Work(task, context, count);
+    // Wait for the tasks to finish, and for workers to stop looking for
+    // more, before the next Run() changes them.
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (done_ < count_ || busy_) finished_.wait(lock);
+  }
+
+ private:
+  // You shouldn't really be copying instances of this class.
+  ThreadPool(const ThreadPool &);
+  ThreadPool &operator=(const ThreadPool &);
+
+  void Work(void (*task)(void *context, size_t i), void *context,
+            size_t count) {
+    size_t done = 0;
+    for (;;) {
+      AUTO_VAR(i, next_++);
+      if (i >= count) break;
+      task(context, i);
+      done++;
+    }
+    if (done) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_ += done;
+    }
+  }
+
+  void WorkerLoop() {
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      while (!stop_ && generation_ == seen) wake_.wait(lock);
+      if (stop_) return;
+      seen = generation_;
+      // A worker waking up late may find the tasks all done, and Run()
+      // returned: the next Run() could then change them at any time.
+      if (done_ >= count_) continue;
+      // Run() waits for busy workers, so these stay valid until then.
+      AUTO_VAR(task, task_);
+      AUTO_VAR(context, context_);
+      AUTO_VAR(count, count_);
+      busy_++;
+      lock.unlock();
+      Work(task, context, count);
+      lock.lock();
+      busy_--;
+      finished_.notify_all();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex run_mutex_;  // One Run() at a time.
+  std::mutex mutex_;      // For everything below.
+  std::condition_variable wake_;
+  std::condition_variable finished_;
+  void (*task_)(void *context, size_t i);
+  void *context_;
+  size_t count_;
+  std::atomic<size_t> next_;  // Next task to be taken.
+  size_t done_;
+  size_t generation_;  // Of Run() calls.
+  size_t busy_;  // Workers in Work().
+  bool stop_;
+};
+
+}  // namespace flatbuffers
+
+#endif  // FLATBUFFERS_THREAD_POOL_H_
@@ -34,8 +34,11 @@
 #include <winbase.h>
 #include <direct.h>
 #else
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <unistd.h>
 #endif
 
 namespace flatbuffers {
@@ -119,6 +122,137 @@ inline bool SaveFile(const char *name, const std::string &buf, bool binary) {
   return SaveFile(name, buf.c_str(), buf.size(), binary);
 }
 
+// How a MappedBuffer will be read, passed on to the OS to tune how much it
+// reads ahead of the pages accessed.
+enum MapAdvice {
+  kMapNormal,
+  kMapSequential,  // Front to back, once (e.g. converting it to text).
+  kMapRandom,      // Scattered reads (e.g. looking up a few tables).
+  kMapWillNeed     // All of it, soon: start reading it in right away.
+};
+
+// A file mapped into memory read-only, instead of loaded into a copy as
+// LoadFile() does: pages are read from disk only when accessed, and are
+// shared with the OS's file cache. The data can be used in place:
+//   MappedBuffer buf("monster.bin");
+//   Verifier verifier(buf.data(), buf.size());
+//   if (buf.ok() && VerifyMonsterBuffer(verifier))
+//     auto monster = GetMonster(buf.data());
+// Mappings start at a page boundary, so they're aligned for any buffer.
+// Files that can't be mapped (e.g. pipes) are loaded into memory instead.
+class MappedBuffer {
+ public:
+  MappedBuffer() : data_(nullptr), size_(0), mapped_(false), ok_(false) {}
+
+  explicit MappedBuffer(const char *name, MapAdvice advice = kMapNormal)
+    : data_(nullptr), size_(0), mapped_(false), ok_(false) {
+    Map(name, advice);
+  }
+
+  ~MappedBuffer() { Unmap(); }
+
+  // Map file "name", in place of what was mapped before. Returns false if
+  // it couldn't be read.
+  bool Map(const char *name, MapAdvice advice = kMapNormal) {
+    Unmap();
+    #ifdef _WIN32
+      // Windows takes its hints when the file is opened.
+      DWORD flags = advice == kMapSequential ? FILE_FLAG_SEQUENTIAL_SCAN
+                  : advice == kMapRandom ? FILE_FLAG_RANDOM_ACCESS
+                  : FILE_ATTRIBUTE_NORMAL;
+      HANDLE file = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, flags, nullptr);
+      if (file == INVALID_HANDLE_VALUE) return false;
+      LARGE_INTEGER size;
+      if (GetFileSizeEx(file, &size) && size.QuadPart > 0 &&
+          static_cast<uint64_t>(size.QuadPart) <= ~static_cast<size_t>(0)) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0,
+                                            0, nullptr);
+        if (mapping) {
+          data_ = static_cast<const uint8_t *>(
+                    MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+          CloseHandle(mapping);  // The view keeps the mapping alive.
+        }
+        if (data_) size_ = static_cast<size_t>(size.QuadPart);
+      }
+      CloseHandle(file);
+    #else
+      int fd = open(name, O_RDONLY);
+      if (fd < 0) return false;
+      struct stat st;
+      if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                       MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+          data_ = static_cast<const uint8_t *>(p);
+          size_ = static_cast<size_t>(st.st_size);
+        }
+      }
+      close(fd);  // The mapping keeps the file open.
+    #endif
+    if (data_) {
+      mapped_ = true;
+      Advise(advice);
+    } else {
+      // Empty, or not something that can be mapped.
+      if (!LoadFile(name, true, &contents_)) return false;
+      data_ = reinterpret_cast<const uint8_t *>(contents_.data());
+      size_ = contents_.size();
+    }
+    ok_ = true;
+    return true;
+  }
+
+  // Release the mapping. Pointers into it are no longer valid after this.
+  void Unmap() {
+    if (mapped_) {
+      #ifdef _WIN32
+        UnmapViewOfFile(data_);
+      #else
+        munmap(const_cast<uint8_t *>(data_), size_);
+      #endif
+    }
+    contents_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    ok_ = false;
+  }
+
+  // Tell the OS how the mapping will be read from now on. Does nothing on
+  // Windows, or if the file was loaded instead.
+  void Advise(MapAdvice advice) const {
+    #ifndef _WIN32
+      if (!mapped_) return;
+      int flag = advice == kMapSequential ? MADV_SEQUENTIAL
+               : advice == kMapRandom ? MADV_RANDOM
+               : advice == kMapWillNeed ? MADV_WILLNEED
+               : MADV_NORMAL;
+      madvise(const_cast<uint8_t *>(data_), size_, flag);
+    #else
+      (void)advice;
+    #endif
+  }
+
+  // Whether the last Map() succeeded.
+  bool ok() const { return ok_; }
+  // Whether the file is mapped, rather than loaded into memory.
+  bool mapped() const { return mapped_; }
+  const uint8_t *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  // You shouldn't really be copying instances of this class.
+  MappedBuffer(const MappedBuffer &);
+  MappedBuffer &operator=(const MappedBuffer &);
+
+  const uint8_t *data_;
+  size_t size_;
+  bool mapped_;
+  bool ok_;
+  std::string contents_;  // If the file couldn't be mapped.
+};
+
 // Functionality for minimalistic portable path handling:
 
 #ifdef __BCPLUSPLUS__
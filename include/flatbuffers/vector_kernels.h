@@ -0,0 +1,198 @@
+/*
+ * Copyright 2015 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLATBUFFERS_VECTOR_KERNELS_H_
+#define FLATBUFFERS_VECTOR_KERNELS_H_
+
+#include <limits>
+
+#include "flatbuffers/flatbuffers.h"
+
+// Aggregates and filters over vectors of scalars, and over a field of the
+// structs in a vector of structs, working on Vector::Data() directly rather
+// than through Get().
+// On little endian hosts, ReadScalar() is a plain load, and the loops below
+// are written such that compilers turn them into SIMD code: 4 independent
+// accumulators, no branches that depend on the data, and (for struct
+// fields) a stride known at compile time. On big endian hosts the same
+// loops byte swap each element.
+// A null vector is treated as empty, like VectorLength() does.
+
+namespace flatbuffers {
+
+// The type sums are accumulated in, wide enough to not overflow.
+template<typename T> struct SumType { typedef int64_t type; };
+template<> struct SumType<uint8_t> { typedef uint64_t type; };
+template<> struct SumType<uint16_t> { typedef uint64_t type; };
+template<> struct SumType<uint32_t> { typedef uint64_t type; };
+template<> struct SumType<uint64_t> { typedef uint64_t type; };
+template<> struct SumType<float> { typedef double type; };
+template<> struct SumType<double> { typedef double type; };
+
+namespace kernels {
+
+// The kernels all work on `count` elements of type T starting at `data`,
+// `Stride` bytes apart.
+
+template<typename T, size_t Stride> typename SumType<T>::type Sum(
+                                         const uint8_t *data, size_t count) {
+  typedef typename SumType<T>::type S;
+  S acc[4] = { 0, 0, 0, 0 };
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    for (size_t j = 0; j < 4; j++)
+      acc[j] += static_cast<S>(ReadScalar<T>(data + (i + j) * Stride));
+  }
+  for (; i < count; i++)
+    acc[0] += static_cast<S>(ReadScalar<T>(data + i * Stride));
+  return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// Max if IsMax, min otherwise. Empty vectors give the lowest or highest
+// value of T respectively.
+template<typename T, size_t Stride, bool IsMax> T MinMax(const uint8_t *data,
+                                                         size_t count) {
+  T init = IsMax ? std::numeric_limits<T>::lowest()
+                 : std::numeric_limits<T>::max();
+  T acc[4] = { init, init, init, init };
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    for (size_t j = 0; j < 4; j++) {
+      AUTO_VAR(v, ReadScalar<T>(data + (i + j) * Stride));
+      acc[j] = (IsMax ? v > acc[j] : v < acc[j]) ? v : acc[j];
+    }
+  }
+  for (; i < count; i++) {
+    AUTO_VAR(v, ReadScalar<T>(data + i * Stride));
+    acc[0] = (IsMax ? v > acc[0] : v < acc[0]) ? v : acc[0];
+  }
+  for (size_t j = 1; j < 4; j++)
+    acc[0] = (IsMax ? acc[j] > acc[0] : acc[j] < acc[0]) ? acc[j] : acc[0];
+  return acc[0];
+}
+
+template<typename T, size_t Stride, typename P> size_t Count(
+                                  const uint8_t *data, size_t count, P pred) {
+  size_t n = 0;
+  for (size_t i = 0; i < count; i++)
+    n += pred(ReadScalar<T>(data + i * Stride)) ? 1 : 0;
+  return n;
+}
+
+// Replaces the contents of `indices` with those of the elements `pred` is
+// true for, in order. Written without branches, as the outcome of `pred`
+// is typically unpredictable.
+template<typename T, size_t Stride, typename P> void Filter(
+                                  const uint8_t *data, size_t count, P pred,
+                                  std::vector<uoffset_t> *indices) {
+  indices->resize(count);
+  AUTO_VAR(out, indices->data());
+  size_t n = 0;
+  for (size_t i = 0; i < count; i++) {
+    out[n] = static_cast<uoffset_t>(i);
+    n += pred(ReadScalar<T>(data + i * Stride)) ? 1 : 0;
+  }
+  indices->resize(n);
+}
+
+template<typename T, size_t Stride> void Extract(const uint8_t *data,
+                                                 size_t count, T *out) {
+  for (size_t i = 0; i < count; i++)
+    out[i] = ReadScalar<T>(data + i * Stride);
+}
+
+}  // namespace kernels
+
+// Vectors of scalars.
+
+template<typename T> typename SumType<T>::type VectorSum(const Vector<T> *v) {
+  return kernels::Sum<T, sizeof(T)>(v ? v->Data() : nullptr,
+                                    VectorLength(v));
+}
+
+template<typename T> T VectorMin(const Vector<T> *v) {
+  return kernels::MinMax<T, sizeof(T), false>(v ? v->Data() : nullptr,
+                                              VectorLength(v));
+}
+
+template<typename T> T VectorMax(const Vector<T> *v) {
+  return kernels::MinMax<T, sizeof(T), true>(v ? v->Data() : nullptr,
+                                             VectorLength(v));
+}
+
+// Number of elements `pred(element)` is true for.
+template<typename T, typename P> size_t VectorCount(const Vector<T> *v,
+                                                    P pred) {
+  return kernels::Count<T, sizeof(T)>(v ? v->Data() : nullptr,
+                                      VectorLength(v), pred);
+}
+
+// Set `indices` to the (ascending) indices of the elements `pred(element)`
+// is true for.
+template<typename T, typename P> void VectorFilter(
+                                          const Vector<T> *v, P pred,
+                                          std::vector<uoffset_t> *indices) {
+  kernels::Filter<T, sizeof(T)>(v ? v->Data() : nullptr, VectorLength(v),
+                                pred, indices);
+}
+
+// A field of type F at byte `offset` of the structs in a vector of
+// structs. Generated structs have the offsets of their fields as
+// constants, e.g. to sum the x of a vector of Vec3:
+//   FieldSum<float>(monster->path(), Vec3::OFFSET_X)
+
+template<typename F, typename S> typename SumType<F>::type FieldSum(
+                              const Vector<const S *> *v, size_t offset) {
+  return kernels::Sum<F, sizeof(S)>(v ? v->Data() + offset : nullptr,
+                                    VectorLength(v));
+}
+
+template<typename F, typename S> F FieldMin(const Vector<const S *> *v,
+                                            size_t offset) {
+  return kernels::MinMax<F, sizeof(S), false>(
+           v ? v->Data() + offset : nullptr, VectorLength(v));
+}
+
+template<typename F, typename S> F FieldMax(const Vector<const S *> *v,
+                                            size_t offset) {
+  return kernels::MinMax<F, sizeof(S), true>(
+           v ? v->Data() + offset : nullptr, VectorLength(v));
+}
+
+template<typename F, typename S, typename P> size_t FieldCount(
+                       const Vector<const S *> *v, size_t offset, P pred) {
+  return kernels::Count<F, sizeof(S)>(v ? v->Data() + offset : nullptr,
+                                      VectorLength(v), pred);
+}
+
+template<typename F, typename S, typename P> void FieldFilter(
+                       const Vector<const S *> *v, size_t offset, P pred,
+                       std::vector<uoffset_t> *indices) {
+  kernels::Filter<F, sizeof(S)>(v ? v->Data() + offset : nullptr,
+                                VectorLength(v), pred, indices);
+}
+
+// Copy the field of each struct into `out`, which must have room for
+// VectorLength(v) elements, in native byte order.
+template<typename F, typename S> void ExtractField(const Vector<const S *> *v,
+                                                   size_t offset, F *out) {
+  kernels::Extract<F, sizeof(S)>(v ? v->Data() + offset : nullptr,
+                                 VectorLength(v), out);
+}
+
+}  // namespace flatbuffers
+
+#endif  // FLATBUFFERS_VECTOR_KERNELS_H_
@@ -52,30 +52,53 @@ MANUALLY_ALIGNED_STRUCT(4) Vec3 FLATBUFFERS_FINAL_CLASS {
   float x() const { return flatbuffers::EndianScalar(x_); }
   float y() const { return flatbuffers::EndianScalar(y_); }
   float z() const { return flatbuffers::EndianScalar(z_); }
+  enum {
+    OFFSET_X = 0,
+    OFFSET_Y = 4,
+    OFFSET_Z = 8
+  };
 };
 STRUCT_END(Vec3, 12);
 
 struct Monster FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const Vec3 *pos() const { return GetStruct<const Vec3 *>(4); }
+  const Vec3 *pos(flatbuffers::Verifier &verifier) const { return verifier.GetStruct<const Vec3 *>(this, 4); }
   int16_t mana() const { return GetField<int16_t>(6, 150); }
+  int16_t mana(flatbuffers::Verifier &verifier) const { return verifier.GetField<int16_t>(this, 6, 150); }
   int16_t hp() const { return GetField<int16_t>(8, 100); }
+  int16_t hp(flatbuffers::Verifier &verifier) const { return verifier.GetField<int16_t>(this, 8, 100); }
   const flatbuffers::String *name() const { return GetPointer<const flatbuffers::String *>(10); }
+  const flatbuffers::String *name(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::String *>(this, 10); }
   const flatbuffers::Vector<uint8_t> *inventory() const { return GetPointer<const flatbuffers::Vector<uint8_t> *>(14); }
+  const flatbuffers::Vector<uint8_t> *inventory(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::Vector<uint8_t> *>(this, 14); }
   Color color() const { return static_cast<Color>(GetField<int8_t>(16, 2)); }
+  Color color(flatbuffers::Verifier &verifier) const { return static_cast<Color>(verifier.GetField<int8_t>(this, 16, 2)); }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
-           VerifyField<Vec3>(verifier, 4 /* pos */) &&
-           VerifyField<int16_t>(verifier, 6 /* mana */) &&
-           VerifyField<int16_t>(verifier, 8 /* hp */) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 10 /* name */) &&
-           verifier.Verify(name()) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 14 /* inventory */) &&
-           verifier.Verify(inventory()) &&
-           VerifyField<int8_t>(verifier, 16 /* color */) &&
+           verifier.Field("pos", VerifyField<Vec3>(verifier, 4)) &&
+           verifier.Field("mana", VerifyField<int16_t>(verifier, 6)) &&
+           verifier.Field("hp", VerifyField<int16_t>(verifier, 8)) &&
+           verifier.Field("name", VerifyField<flatbuffers::uoffset_t>(verifier, 10) &&
+                                  verifier.Verify(name())) &&
+           verifier.Field("inventory", VerifyField<flatbuffers::uoffset_t>(verifier, 14) &&
+                                       verifier.Verify(inventory())) &&
+           verifier.Field("color", VerifyField<int8_t>(verifier, 16)) &&
            verifier.EndTable();
   }
 };
 
+struct MonsterView : public flatbuffers::TableView<7> {
+  MonsterView() {}
+  explicit MonsterView(const Monster *table) : flatbuffers::TableView<7>(table) {}
+  void Reset(const Monster *table) { flatbuffers::TableView<7>::Reset(table); }
+  const Vec3 *pos() const { return GetStruct<const Vec3 *>(4); }
+  int16_t mana() const { return GetField<int16_t>(6, 150); }
+  int16_t hp() const { return GetField<int16_t>(8, 100); }
+  const flatbuffers::String *name() const { return GetPointer<const flatbuffers::String *>(10); }
+  const flatbuffers::Vector<uint8_t> *inventory() const { return GetPointer<const flatbuffers::Vector<uint8_t> *>(14); }
+  Color color() const { return static_cast<Color>(GetField<int8_t>(16, 2)); }
+};
+
 struct MonsterBuilder {
   flatbuffers::FlatBufferBuilder &fbb_;
   flatbuffers::uoffset_t start_;
@@ -114,16 +137,22 @@ inline bool VerifyAny(flatbuffers::Verifier &verifier, const void *union_obj, An
   switch (type) {
     case Any_NONE: return true;
     case Any_Monster: return verifier.VerifyTable(reinterpret_cast<const Monster *>(union_obj));
-    default: return false;
+    default: return verifier.Fail(union_obj);
   }
 }
 
 inline const Monster *GetMonster(const void *buf) { return flatbuffers::GetRoot<Monster>(buf); }
 
+inline const Monster *GetSizePrefixedMonster(const void *buf) { return flatbuffers::GetSizePrefixedRoot<Monster>(buf); }
+
 inline bool VerifyMonsterBuffer(flatbuffers::Verifier &verifier) { return verifier.VerifyBuffer<Monster>(); }
 
+inline bool VerifySizePrefixedMonsterBuffer(flatbuffers::Verifier &verifier) { return verifier.VerifySizePrefixedBuffer<Monster>(); }
+
 inline void FinishMonsterBuffer(flatbuffers::FlatBufferBuilder &fbb, flatbuffers::Offset<Monster> root) { fbb.Finish(root); }
 
+inline void FinishSizePrefixedMonsterBuffer(flatbuffers::FlatBufferBuilder &fbb, flatbuffers::Offset<Monster> root) { fbb.FinishSizePrefixed(root); }
+
 }  // namespace Sample
 }  // namespace MyGame
 
@@ -16,6 +16,7 @@
 
 #include <limits>
 
+#include "flatbuffers/archive.h"
 #include "flatbuffers/flatbuffers.h"
 #include "flatbuffers/idl.h"
 #include "flatbuffers/util.h"
@@ -92,6 +93,10 @@ static void Error(const char *err, const char *obj, bool usage,
       "  --gen-includes  Generate include statements for included schemas the\n"
       "                  generated file depends on (C++).\n"
       "  --proto         Input is a .proto, translate to .fbs.\n"
+      "  --pack FILE     Store the binary data of all inputs in archive FILE,\n"
+      "                  keyed by their base file name.\n"
+      "  --unpack        Binary FILEs are archives: generate output for each\n"
+      "                  buffer in them, named by its key if it has one.\n"
       "FILEs may depend on declarations in earlier files.\n"
       "FILEs after the -- must be binary flatbuffer format files.\n"
       "Output files are named using the base file name of the input,\n"
@@ -102,6 +107,36 @@ static void Error(const char *err, const char *obj, bool usage,
   exit(1);
 }
 
+// Run the enabled generators on what `parser` holds, for input `file`, with
+// output files named after `filebase`.
+static void Generate(const flatbuffers::Parser &parser,
+                     const bool *generator_enabled,
+                     flatbuffers::GeneratorOptions &opts,
+                     const std::string &output_path, bool print_make_rules,
+                     const std::string &file, const std::string &filebase) {
+  const size_t num_generators = sizeof(generators) / sizeof(generators[0]);
+  for (size_t i = 0; i < num_generators; ++i) {
+    opts.lang = generators[i].lang;
+    if (generator_enabled[i]) {
+      if (!print_make_rules) {
+        flatbuffers::EnsureDirExists(output_path);
+        if (!generators[i].generate(parser, output_path, filebase, opts)) {
+          Error((std::string("Unable to generate ") +
+                 generators[i].lang_name +
+                 " for " +
+                 filebase).c_str());
+        }
+      } else {
+        std::string make_rule = generators[i].make_rule(
+            parser, output_path, file, opts);
+        if (!make_rule.empty())
+          printf("%s\n", flatbuffers::WordWrap(
+              make_rule, 80, " ", " \\").c_str());
+      }
+    }
+  }
+}
+
 int main(int argc, const char *argv[]) {
   program_name = argv[0];
   flatbuffers::GeneratorOptions opts;
@@ -111,6 +146,8 @@ int main(int argc, const char *argv[]) {
   bool any_generator = false;
   bool print_make_rules = false;
   bool proto_mode = false;
+  const char *pack_file = nullptr;
+  bool unpack = false;
   std::vector<std::string> filenames;
   std::vector<const char *> include_directories;
   size_t binary_files_from = std::numeric_limits<size_t>::max();
@@ -139,6 +176,12 @@ int main(int argc, const char *argv[]) {
         any_generator = true;
       } else if(opt == "-M") {
         print_make_rules = true;
+      } else if(opt == "--pack") {
+        if (++argi >= argc) Error("missing file following", arg, true);
+        pack_file = argv[argi];
+        any_generator = true;
+      } else if(opt == "--unpack") {
+        unpack = true;
       } else {
         for (size_t i = 0; i < num_generators; ++i) {
           if (opt == generators[i].generator_opt) {
@@ -160,23 +203,52 @@ int main(int argc, const char *argv[]) {
   if (!any_generator)
     Error("no options", "specify one of -c -g -j -t -b etc.", true);
 
+  FILE *pack_fp = nullptr;
+  if (pack_file) {
+    pack_fp = fopen(pack_file, "wb");
+    if (!pack_fp) Error("unable to write file", pack_file);
+  }
+  flatbuffers::ArchiveWriter pack(pack_fp ? fileno(pack_fp) : -1);
+
   // Now process the files:
   flatbuffers::Parser parser(opts.strict_json, proto_mode);
   for (AUTO_VAR(file_it, filenames.begin());
             file_it != filenames.end();
           ++file_it) {
-      std::string contents;
-      if (!flatbuffers::LoadFile(file_it->c_str(), true, &contents))
-        Error("unable to load file", file_it->c_str());
-
       bool is_binary = static_cast<size_t>(file_it - filenames.begin()) >=
                        binary_files_from;
-      if (is_binary) {
-        parser.builder_.Clear();
-        parser.builder_.PushBytes(
-          reinterpret_cast<const uint8_t *>(contents.c_str()),
-          contents.length());
+      std::string contents;
+      std::string filebase = flatbuffers::StripPath(
+                               flatbuffers::StripExtension(*file_it));
+      // Binary files are used in place, and read through once.
+      flatbuffers::MappedBuffer mapped;
+      if (is_binary && unpack) {
+        flatbuffers::ArchiveReader archive;
+        if (!archive.Open(file_it->c_str(), flatbuffers::kMapSequential))
+          Error("unable to load archive", file_it->c_str());
+        for (size_t i = 0; i < archive.size(); i++) {
+          size_t len = 0;
+          AUTO_VAR(buf, archive.Get(i, &len));
+          if (!buf) Error("corrupt archive", file_it->c_str());
+          parser.SetBuffer(buf, len);
+          size_t key_len;
+          AUTO_VAR(key, archive.GetKey(i, &key_len));
+          std::string name = key_len
+            ? std::string(key, key_len)
+            : filebase + "_" + flatbuffers::NumToString(i);
+          Generate(parser, generator_enabled, opts, output_path,
+                   print_make_rules, *file_it, name);
+          if (pack_fp) pack.Add(buf, len, name.c_str());
+        }
+        parser.SetBuffer(nullptr, 0);
+        continue;
+      } else if (is_binary) {
+        if (!mapped.Map(file_it->c_str(), flatbuffers::kMapSequential))
+          Error("unable to load file", file_it->c_str());
+        parser.SetBuffer(mapped.data(), mapped.size());
       } else {
+        if (!flatbuffers::LoadFile(file_it->c_str(), true, &contents))
+          Error("unable to load file", file_it->c_str());
         std::string local_include_directory = flatbuffers::StripFileName(*file_it);
         include_directories.push_back(local_include_directory.c_str());
         include_directories.push_back(nullptr);
@@ -187,29 +259,11 @@ int main(int argc, const char *argv[]) {
         include_directories.pop_back();
       }
 
-      std::string filebase = flatbuffers::StripPath(
-                               flatbuffers::StripExtension(*file_it));
-
-      for (size_t i = 0; i < num_generators; ++i) {
-        opts.lang = generators[i].lang;
-        if (generator_enabled[i]) {
-          if (!print_make_rules) {
-            flatbuffers::EnsureDirExists(output_path);
-            if (!generators[i].generate(parser, output_path, filebase, opts)) {
-              Error((std::string("Unable to generate ") +
-                     generators[i].lang_name +
-                     " for " +
-                     filebase).c_str());
-            }
-          } else {
-            std::string make_rule = generators[i].make_rule(
-                parser, output_path, *file_it, opts);
-            if (!make_rule.empty())
-              printf("%s\n", flatbuffers::WordWrap(
-                  make_rule, 80, " ", " \\").c_str());
-          }
-        }
-      }
+      Generate(parser, generator_enabled, opts, output_path, print_make_rules,
+               *file_it, filebase);
+      if (pack_fp && parser.GetBufferSize())
+        pack.Add(parser.GetBufferPointer(), parser.GetBufferSize(),
+                 filebase.c_str());
 
       if (proto_mode) GenerateFBS(parser, output_path, filebase, opts);
 
@@ -218,5 +272,10 @@ int main(int argc, const char *argv[]) {
       parser.MarkGenerated();
   }
 
+  if (pack_fp) {
+    if (!pack.Finish() || fclose(pack_fp))
+      Error("unable to write file", pack_file);
+  }
+
   return 0;
 }
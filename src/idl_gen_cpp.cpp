@@ -188,7 +188,7 @@ static void GenEnum(const Parser &parser, EnumDef &enum_def,
         code_post += " *>(union_obj));\n";
       }
     }
-    code_post += "    default: return false;\n  }\n}\n\n";
+    code_post += "    default: return verifier.Fail(union_obj);\n  }\n}\n\n";
   }
 }
 
@@ -204,6 +204,15 @@ std::string GenUnderlyingCast(const Parser &parser, const FieldDef &field,
       : val;
 }
 
+static const FieldDef *KeyField(const StructDef &struct_def) {
+  for (AUTO_VAR(it, struct_def.fields.vec.begin());
+       it != struct_def.fields.vec.end();
+       ++it) {
+    if ((*it)->key) return *it;
+  }
+  return nullptr;
+}
+
 // Generate an accessor struct, builder structs & function for a table.
 static void GenTable(const Parser &parser, StructDef &struct_def,
                      const GeneratorOptions &opts, std::string *code_ptr) {
@@ -216,26 +225,39 @@ static void GenTable(const Parser &parser, StructDef &struct_def,
   code += "struct " + struct_def.name;
   code += " FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table";
   code += " {\n";
+  // The same accessors, for the view (see TableView) generated below.
+  std::string view_accessors;
   for (AUTO_VAR(it, struct_def.fields.vec.begin());
        it != struct_def.fields.vec.end();
        ++it) {
     AUTO_VAR(&field, **it);
     if (!field.deprecated) {  // Deprecated fields won't be accessible.
       flatbuffers::GenComment(field.doc_comment, code_ptr, "  ");
-      code += "  " + GenTypeGet(parser, field.value.type, " ", "const ", " *",
-                                true);
-      code += field.name + "() const { return ";
+      std::string accessor = "  ";
+      accessor += GenTypeGet(parser, field.value.type, " ", "const ", " *",
+                             true);
+      accessor += field.name + "() const { return ";
       // Call a different accessor for pointers, that indirects.
-      std::string call = IsScalar(field.value.type.base_type)
+      std::string getter = IsScalar(field.value.type.base_type)
         ? "GetField<"
         : (IsStruct(field.value.type) ? "GetStruct<" : "GetPointer<");
-      call += GenTypeGet(parser, field.value.type, "", "const ", " *", false);
-      call += ">(" + NumToString(field.value.offset);
+      getter += GenTypeGet(parser, field.value.type, "", "const ", " *",
+                           false);
+      std::string args = NumToString(field.value.offset);
       // Default value as second arg for non-pointer types.
       if (IsScalar(field.value.type.base_type))
-        call += ", " + field.value.constant;
-      call += ")";
-      code += GenUnderlyingCast(parser, field, true, call);
+        args += ", " + field.value.constant;
+      std::string call = getter + ">(" + args + ")";
+      accessor += GenUnderlyingCast(parser, field, true, call);
+      accessor += "; }\n";
+      code += accessor;
+      view_accessors += accessor;
+      // The same, checking what it reads (see Verifier::GetRoot()).
+      code += "  " + GenTypeGet(parser, field.value.type, " ", "const ",
+                                " *", true);
+      code += field.name + "(flatbuffers::Verifier &verifier) const { ";
+      code += "return " + GenUnderlyingCast(parser, field, true,
+        "verifier." + getter + ">(this, " + args + ")");
       code += "; }\n";
       AUTO_VAR(nested, field.attributes.Lookup("nested_flatbuffer"));
       if (nested) {
@@ -262,11 +284,66 @@ static void GenTable(const Parser &parser, StructDef &struct_def,
           code += " val) const { return " + field.name + "() < val ? -1 : ";
           code += field.name + "() > val; }\n";
         }
+        code += "  uint32_t KeyHash() const { return flatbuffers::HashKey";
+        if (field.value.type.base_type == BASE_TYPE_STRING) {
+          code += "(" + field.name + "()->c_str()); }\n";
+          code += "  uint64_t KeyPrefix() const { return ";
+          code += "flatbuffers::KeyPrefix(" + field.name + "()->c_str()); }\n";
+        } else {
+          code += "<" + GenTypeBasic(parser, field.value.type, false) + ">(";
+          code += field.name + "()); }\n";
+        }
       }
     }
   }
+  // Generate lookups by key for vectors of tables that are laid out or
+  // indexed for it.
+  for (AUTO_VAR(it, struct_def.fields.vec.begin());
+       it != struct_def.fields.vec.end();
+       ++it) {
+    AUTO_VAR(&vec, **it);
+    if (vec.deprecated) continue;
+    AUTO_VAR(eytzinger, vec.attributes.Lookup("eytzinger") != nullptr);
+    const FieldDef *hash_index = nullptr;
+    const FieldDef *key_prefix = nullptr;
+    for (AUTO_VAR(index, struct_def.fields.vec.begin());
+         index != struct_def.fields.vec.end();
+         ++index) {
+      if ((*index)->deprecated) continue;
+      AUTO_VAR(attr, (*index)->attributes.Lookup("hash_index"));
+      if (attr && attr->constant == vec.name) hash_index = *index;
+      attr = (*index)->attributes.Lookup("key_prefix");
+      if (attr && attr->constant == vec.name) key_prefix = *index;
+    }
+    if (!eytzinger && !hash_index && !key_prefix) continue;
+    AUTO_VAR(&elem, *vec.value.type.struct_def);
+    AUTO_VAR(&key, *KeyField(elem));
+    code += "  const " + WrapInNameSpace(parser, elem) + " *";
+    code += vec.name + "_by_key(";
+    code += key.value.type.base_type == BASE_TYPE_STRING
+      ? "const char *"
+      : GenTypeBasic(parser, key.value.type, false) + " ";
+    code += "key) const {\n";
+    code += "    auto v = " + vec.name + "();\n";
+    code += "    if (!v) return nullptr;\n";
+    if (hash_index) {
+      code += "    auto index = " + hash_index->name + "();\n";
+      code += "    if (index && index->size()) ";
+      code += "return v->LookupByKey(key, index);\n";
+    }
+    if (key_prefix) {
+      code += "    return v->LookupByKeyPrefix(key, " + key_prefix->name;
+      code += std::string("(), ") + (eytzinger ? "true" : "false") + ");\n";
+    } else {
+      code += "    return v->LookupByKey";
+      code += std::string(eytzinger ? "Eytzinger" : "") + "(key);\n";
+    }
+    code += "  }\n";
+  }
   // Generate a verifier function that can check a buffer from an untrusted
-  // source will never cause reads outside the buffer.
+  // source will never cause reads outside the buffer. The checks of each
+  // field are passed to Verifier::Field(), which names the field should
+  // they fail.
   code += "  bool Verify(flatbuffers::Verifier &verifier) const {\n";
   code += "    return VerifyTableStart(verifier)";
   std::string prefix = " &&\n           ";
@@ -275,37 +352,40 @@ static void GenTable(const Parser &parser, StructDef &struct_def,
        ++it) {
     AUTO_VAR(&field, **it);
     if (!field.deprecated) {
-      code += prefix + "VerifyField";
+      std::string field_prefix = " &&\n" +
+        std::string(11 + strlen("verifier.Field(\"\", ") + field.name.size(),
+                    ' ');
+      code += prefix + "verifier.Field(\"" + field.name + "\", ";
+      code += "VerifyField";
       if (field.required) code += "Required";
       code += "<" + GenTypeSize(parser, field.value.type);
-      code += ">(verifier, " + NumToString(field.value.offset);
-      code += " /* " + field.name + " */)";
+      code += ">(verifier, " + NumToString(field.value.offset) + ")";
       switch (field.value.type.base_type) {
         case BASE_TYPE_UNION:
-          code += prefix + "Verify" + field.value.type.enum_def->name;
+          code += field_prefix + "Verify" + field.value.type.enum_def->name;
           code += "(verifier, " + field.name + "(), " + field.name + "_type())";
           break;
         case BASE_TYPE_STRUCT:
           if (!field.value.type.struct_def->fixed) {
-            code += prefix + "verifier.VerifyTable(" + field.name;
+            code += field_prefix + "verifier.VerifyTable(" + field.name;
             code += "())";
           }
           break;
         case BASE_TYPE_STRING:
-          code += prefix + "verifier.Verify(" + field.name + "())";
+          code += field_prefix + "verifier.Verify(" + field.name + "())";
           break;
         case BASE_TYPE_VECTOR:
-          code += prefix + "verifier.Verify(" + field.name + "())";
+          code += field_prefix + "verifier.Verify(" + field.name + "())";
           switch (field.value.type.element) {
             case BASE_TYPE_STRING: {
-              code += prefix + "verifier.VerifyVectorOfStrings(" + field.name;
-              code += "())";
+              code += field_prefix + "verifier.VerifyVectorOfStrings(";
+              code += field.name + "())";
               break;
             }
             case BASE_TYPE_STRUCT: {
               if (!field.value.type.struct_def->fixed) {
-                code += prefix + "verifier.VerifyVectorOfTables(" + field.name;
-                code += "())";
+                code += field_prefix + "verifier.VerifyVectorOfTables(";
+                code += field.name + "())";
               }
               break;
             }
@@ -316,12 +396,26 @@ static void GenTable(const Parser &parser, StructDef &struct_def,
         default:
           break;
       }
+      code += ")";
     }
   }
   code += prefix + "verifier.EndTable()";
   code += ";\n  }\n";
   code += "};\n\n";
 
+  // Generate a view, which reads the same fields through offsets looked up
+  // in the vtable only once per table (or less, if tables share vtables).
+  std::string view_base = "flatbuffers::TableView<" +
+                          NumToString(struct_def.fields.vec.size()) + ">";
+  code += "struct " + struct_def.name + "View : public " + view_base + " {\n";
+  code += "  " + struct_def.name + "View() {}\n";
+  code += "  explicit " + struct_def.name + "View(const " + struct_def.name;
+  code += " *table) : " + view_base + "(table) {}\n";
+  code += "  void Reset(const " + struct_def.name + " *table) { ";
+  code += view_base + "::Reset(table); }\n";
+  code += view_accessors;
+  code += "};\n\n";
+
   // Generate a builder struct, with methods of the form:
   // void add_name(type name) { fbb_.AddElement<type>(offset, name, default); }
   code += "struct " + struct_def.name;
@@ -549,6 +643,21 @@ static void GenStruct(const Parser &parser, StructDef &struct_def,
         : field.name + "_");
     code += "; }\n";
   }
+
+  // Generate the byte offsets of the fields, for flatbuffers::FieldSum()
+  // and friends in vector_kernels.h.
+  code += "  enum {\n";
+  for (AUTO_VAR(it, struct_def.fields.vec.begin());
+       it != struct_def.fields.vec.end();
+       ++it) {
+    AUTO_VAR(&field, **it);
+    std::string name = field.name;
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    code += "    OFFSET_" + name + " = " + NumToString(field.value.offset);
+    code += std::string(it + 1 != struct_def.fields.vec.end() ? "," : "");
+    code += "\n";
+  }
+  code += "  };\n";
   code += "};\nSTRUCT_END(" + struct_def.name + ", ";
   code += NumToString(struct_def.bytesize) + ");\n\n";
 }
@@ -701,6 +810,11 @@ std::string GenerateCPP(const Parser &parser,
       code += "(const void *buf) { return flatbuffers::GetRoot<";
       code += name + ">(buf); }\n\n";
 
+      code += "inline const " + name + " *GetSizePrefixed";
+      code += name;
+      code += "(const void *buf) { return flatbuffers::GetSizePrefixedRoot<";
+      code += name + ">(buf); }\n\n";
+
       // The root verifier:
       code += "inline bool Verify";
       code += name;
@@ -708,6 +822,12 @@ std::string GenerateCPP(const Parser &parser,
               "return verifier.VerifyBuffer<";
       code += name + ">(); }\n\n";
 
+      code += "inline bool VerifySizePrefixed";
+      code += name;
+      code += "Buffer(flatbuffers::Verifier &verifier) { "
+              "return verifier.VerifySizePrefixedBuffer<";
+      code += name + ">(); }\n\n";
+
       if (parser.file_identifier_.length()) {
         // Return the identifier
         code += "inline const char *" + name;
@@ -729,6 +849,13 @@ std::string GenerateCPP(const Parser &parser,
         code += ", " + name + "Identifier()";
       code += "); }\n\n";
 
+      code += "inline void FinishSizePrefixed" + name;
+      code += "Buffer(flatbuffers::FlatBufferBuilder &fbb, flatbuffers::Offset<";
+      code += name + "> root) { fbb.FinishSizePrefixed(root";
+      if (parser.file_identifier_.length())
+        code += ", " + name + "Identifier()";
+      code += "); }\n\n";
+
     }
 
     CloseNestedNameSpaces(name_space, &code);
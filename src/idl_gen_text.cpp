@@ -105,15 +105,16 @@ static void EscapeString(const String &s, std::string *_text) {
         if (c >= ' ' && c <= '~') {
           text += c;
         } else {
-          // Not printable ASCII data. Let's see if it's valid UTF-8 first:
-          const char *utf8 = s.c_str() + i;
-          int ucc = FromUTF8(&utf8);
-          if (ucc >= 0x80 && ucc <= 0xFFFF) {
+          // Not printable ASCII data. Let's see if it's valid UTF-8 first,
+          // checked as strictly as by Verifier::SetVerifyUTF8():
+          uint32_t ucc;
+          AUTO_VAR(len, DecodeUTF8Sequence(s.Data() + i, s.size() - i, &ucc));
+          if (len && ucc <= 0xFFFF) {
             // Parses as Unicode within JSON's \uXXXX range, so use that.
             text += "\\u";
             text += IntToStringHex(ucc, 4);
             // Skip past characters recognized.
-            i = static_cast<uoffset_t>(utf8 - s.c_str() - 1);
+            i += static_cast<uoffset_t>(len) - 1;
           } else {
             // It's either unprintable ASCII, arbitrary binary, or Unicode data
             // that doesn't fit \uXXXX, so use \xXX escape code instead.
@@ -277,10 +278,9 @@ bool GenerateTextFile(const Parser &parser,
                       const std::string &path,
                       const std::string &file_name,
                       const GeneratorOptions &opts) {
-  if (!parser.builder_.GetSize() || !parser.root_struct_def) return true;
+  if (!parser.GetBufferSize() || !parser.root_struct_def) return true;
   std::string text;
-  GenerateText(parser, parser.builder_.GetBufferPointer(), opts,
-               &text);
+  GenerateText(parser, parser.GetBufferPointer(), opts, &text);
   return flatbuffers::SaveFile(TextFileName(path, file_name).c_str(),
                                text,
                                false);
@@ -290,7 +290,7 @@ std::string TextMakeRule(const Parser &parser,
                          const std::string &path,
                          const std::string &file_name,
                          const GeneratorOptions & /*opts*/) {
-  if (!parser.builder_.GetSize() || !parser.root_struct_def) return "";
+  if (!parser.GetBufferSize() || !parser.root_struct_def) return "";
   std::string filebase = flatbuffers::StripPath(
       flatbuffers::StripExtension(file_name));
   std::string make_rule = TextFileName(path, filebase) + ": " + file_name;
@@ -489,7 +489,7 @@ void Parser::ParseAnyValue(Value &val, FieldDef *field) {
     }
     case BASE_TYPE_VECTOR: {
       Expect('[');
-      val.constant = NumToString(ParseVector(val.type.VectorType()));
+      val.constant = NumToString(ParseVector(val.type.VectorType(), field));
       break;
     }
     case BASE_TYPE_INT:
@@ -519,6 +519,160 @@ void Parser::SerializeStruct(const StructDef &struct_def, const Value &val) {
   builder_.AddStructOffset(val.offset, builder_.GetSize());
 }
 
+static bool IsKeyedTableVector(const FieldDef *field) {
+  return field &&
+         field->value.type.base_type == BASE_TYPE_VECTOR &&
+         field->value.type.element == BASE_TYPE_STRUCT &&
+         !field->value.type.struct_def->fixed &&
+         field->value.type.struct_def->has_key;
+}
+
+static const FieldDef &KeyField(const StructDef &struct_def) {
+  AUTO_VAR(&fields, struct_def.fields.vec);
+  AUTO_VAR(it, fields.begin());
+  while (!(*it)->key) ++it;
+  return **it;
+}
+
+// Compares, hashes etc. the keys of tables already in the builder, like the
+// Key*() functions generated for them do, given their offsets.
+class TableKeys {
+ public:
+  TableKeys(const FlatBufferBuilder &builder, const FieldDef &key)
+    : end_(builder.GetBufferPointer() + builder.GetSize()), key_(&key) {}
+
+  const Table *Get(uoffset_t o) const {
+    return reinterpret_cast<const Table *>(end_ - o);
+  }
+
+  bool IsString() const {
+    return key_->value.type.base_type == BASE_TYPE_STRING;
+  }
+
+  const char *String(const Table *t) const {
+    AUTO_VAR(s, t->GetPointer<const flatbuffers::String *>(key_->value.offset));
+    return s ? s->c_str() : nullptr;
+  }
+
+  bool operator()(uoffset_t a, uoffset_t b) const {
+    switch (key_->value.type.base_type) {
+      #define FLATBUFFERS_TD(ENUM, IDLTYPE, CTYPE, JTYPE, GTYPE, NTYPE) \
+        case BASE_TYPE_ ## ENUM: \
+          return Scalar<CTYPE>(Get(a)) < Scalar<CTYPE>(Get(b));
+        FLATBUFFERS_GEN_TYPES_SCALAR(FLATBUFFERS_TD)
+      #undef FLATBUFFERS_TD
+      default:
+        return strcmp(String(Get(a)), String(Get(b))) < 0;
+    }
+  }
+
+  uint32_t Hash(const Table *t) const {
+    switch (key_->value.type.base_type) {
+      #define FLATBUFFERS_TD(ENUM, IDLTYPE, CTYPE, JTYPE, GTYPE, NTYPE) \
+        case BASE_TYPE_ ## ENUM: \
+          return HashKey<CTYPE>(Scalar<CTYPE>(t));
+        FLATBUFFERS_GEN_TYPES_SCALAR(FLATBUFFERS_TD)
+      #undef FLATBUFFERS_TD
+      default:
+        return HashKey(String(t));
+    }
+  }
+
+ private:
+  template<typename T> T Scalar(const Table *t) const {
+    return t->GetField<T>(key_->value.offset,
+                          atot<T>(key_->value.constant.c_str()));
+  }
+
+  const uint8_t *end_;
+  const FieldDef *key_;
+};
+
+void Parser::CheckKeys(const TableKeys &keys, const uoffset_t *tables,
+                       size_t len) {
+  if (!keys.IsString()) return;
+  for (size_t i = 0; i < len; i++) {
+    if (!keys.String(keys.Get(tables[i])))
+      Error("missing key field in a table of a keyed vector");
+  }
+}
+
+// Store the `count` tables on top of the field stack in Eytzinger order, as
+// FlatBufferBuilder::CreateVectorOfEytzingerTables() does.
+void Parser::EytzingerOrder(const StructDef &struct_def, size_t count) {
+  AUTO_VAR(first, field_stack_.size() - count);
+  std::vector<uoffset_t> sorted(count);
+  for (size_t i = 0; i < count; i++)
+    sorted[i] = atot<uoffset_t>(field_stack_[first + i].first.constant.c_str());
+  TableKeys keys(builder_, KeyField(struct_def));
+  CheckKeys(keys, sorted.data(), count);
+  std::sort(sorted.begin(), sorted.end(), keys);
+  for (size_t i = 0; i < count; i++) {
+    AUTO_VAR(index, EytzingerIndex(static_cast<uoffset_t>(i),
+                                   static_cast<uoffset_t>(count)));
+    field_stack_[first + index].first.constant = NumToString(sorted[i]);
+  }
+}
+
+// Add the hash_index and key_prefix fields left out of the `fieldn` fields
+// of a table on top of the field stack, for the vectors they index that are
+// there. Returns how many were added.
+size_t Parser::AddKeyIndexes(const StructDef &struct_def, size_t fieldn) {
+  AUTO_VAR(first, field_stack_.size() - fieldn);
+  size_t added = 0;
+  AUTO_VAR(&fields, struct_def.fields.vec);
+  for (AUTO_VAR(it, fields.begin()); it != fields.end(); ++it) {
+    AUTO_VAR(hash_index, (*it)->attributes.Lookup("hash_index"));
+    AUTO_VAR(key_prefix, (*it)->attributes.Lookup("key_prefix"));
+    AUTO_VAR(attr, hash_index ? hash_index : key_prefix);
+    if (!attr) continue;
+    // Whether the attributes are valid is only checked at the end of the
+    // schema, so skip any that aren't.
+    AUTO_VAR(vec_field, struct_def.fields.Lookup(attr->constant));
+    if (!IsKeyedTableVector(vec_field)) continue;
+    const Value *vec_val = nullptr;
+    bool given = false;
+    for (size_t i = first; i < first + fieldn; i++) {
+      if (field_stack_[i].second == *it) given = true;
+      if (field_stack_[i].second == vec_field) vec_val = &field_stack_[i].first;
+    }
+    if (given || !vec_val) continue;
+    TableKeys keys(builder_, KeyField(*vec_field->value.type.struct_def));
+    if (!hash_index && !keys.IsString()) continue;
+    AUTO_VAR(vec, reinterpret_cast<const Vector<Offset<Table> > *>(
+                    keys.Get(atot<uoffset_t>(vec_val->constant.c_str()))));
+    // Offsets of the tables, from the end of the buffer.
+    std::vector<uoffset_t> tables(vec->size());
+    AUTO_VAR(end, builder_.GetBufferPointer() + builder_.GetSize());
+    for (uoffset_t i = 0; i < vec->size(); i++) {
+      tables[i] = static_cast<uoffset_t>(
+        end - reinterpret_cast<const uint8_t *>(vec->Get(i)));
+    }
+    CheckKeys(keys, tables.data(), tables.size());
+    Value val = (*it)->value;
+    if (hash_index) {
+      // See FlatBufferBuilder::CreateKeyHashIndex().
+      uoffset_t slots = tables.size() ? 2 : 0;
+      while (slots < tables.size() * 2) slots *= 2;
+      std::vector<uoffset_t> index(slots, 0);
+      for (size_t i = 0; i < tables.size(); i++) {
+        AUTO_VAR(slot, keys.Hash(keys.Get(tables[i])) & (slots - 1));
+        while (index[slot]) slot = (slot + 1) & (slots - 1);
+        index[slot] = static_cast<uoffset_t>(i + 1);
+      }
+      val.constant = NumToString(builder_.CreateVector(index).o);
+    } else {
+      std::vector<uint64_t> prefixes(tables.size());
+      for (size_t i = 0; i < tables.size(); i++)
+        prefixes[i] = KeyPrefix(keys.String(keys.Get(tables[i])));
+      val.constant = NumToString(builder_.CreateVector(prefixes).o);
+    }
+    field_stack_.push_back(std::make_pair(val, *it));
+    added++;
+  }
+  return added;
+}
+
 uoffset_t Parser::ParseTable(const StructDef &struct_def) {
   Expect('{');
   size_t fieldn = 0;
@@ -551,6 +705,7 @@ uoffset_t Parser::ParseTable(const StructDef &struct_def) {
            it != field_stack_.rbegin() + fieldn; ++it) {
     it->second->used = false;
   }
+  if (!struct_def.fixed) fieldn += AddKeyIndexes(struct_def, fieldn);
   if (struct_def.fixed && fieldn != struct_def.fields.vec.size())
     Error("incomplete struct initialization: " + struct_def.name);
   decltype(builder_.StartTable()) start = struct_def.fixed
@@ -616,7 +771,7 @@ uoffset_t Parser::ParseTable(const StructDef &struct_def) {
   }
 }
 
-uoffset_t Parser::ParseVector(const Type &type) {
+uoffset_t Parser::ParseVector(const Type &type, const FieldDef *field) {
   int count = 0;
   for (;;) {
     if ((!strict_json_ || !count) && IsNext(']')) break;
@@ -628,6 +783,8 @@ uoffset_t Parser::ParseVector(const Type &type) {
     if (IsNext(']')) break;
     Expect(',');
   }
+  if (IsKeyedTableVector(field) && field->attributes.Lookup("eytzinger"))
+    EytzingerOrder(*type.struct_def, count);
 
   builder_.StartVector(count * InlineSize(type) / InlineAlignment(type),
                        InlineAlignment(type));
@@ -965,6 +1122,33 @@ void Parser::ParseDecl() {
   Expect('}');
 }
 
+// Check a field holding an index of a vector of tables by their key, which
+// the vector field is named by `attribute` of (e.g. hash_index: "monsters").
+void Parser::CheckIndexField(const StructDef &struct_def,
+                             const FieldDef &field, const char *attribute,
+                             BaseType element, bool string_key) {
+  AUTO_VAR(vec_name, field.attributes.Lookup(attribute));
+  if (!vec_name) return;
+  std::string attr = attribute;
+  if (vec_name->type.base_type != BASE_TYPE_STRING)
+    Error(attr + " attribute must be a string (the vector field)");
+  if (field.value.type.base_type != BASE_TYPE_VECTOR ||
+      field.value.type.element != element)
+    Error(attr + " attribute may only apply to a vector of " +
+          kTypeNames[element]);
+  AUTO_VAR(vec, struct_def.fields.Lookup(vec_name->constant));
+  if (!IsKeyedTableVector(vec))
+    Error(attr + " attribute must name a vector of tables with a key field"
+          " in the same table: " + vec_name->constant);
+  if (string_key) {
+    AUTO_VAR(&elem_fields, vec->value.type.struct_def->fields.vec);
+    for (AUTO_VAR(it, elem_fields.begin()); it != elem_fields.end(); ++it) {
+      if ((*it)->key && (*it)->value.type.base_type != BASE_TYPE_STRING)
+        Error(attr + " attribute requires a string key: " + vec->name);
+    }
+  }
+}
+
 bool Parser::SetRootType(const char *name) {
   root_struct_def = structs_.Lookup(name);
   return root_struct_def != nullptr;
@@ -1113,7 +1297,7 @@ bool Parser::Parse(const char *source, const char **include_paths,
   source_ = cursor_ = source;
   line_ = 1;
   error_.clear();
-  builder_.Clear();
+  SetBuffer(nullptr, 0);
   try {
     Next();
     // Includes must come first:
@@ -1210,6 +1394,19 @@ bool Parser::Parse(const char *source, const char **include_paths,
       if ((*it)->predecl)
         Error("type referenced but not defined: " + (*it)->name);
     }
+    // Only now that all tables are defined do we know which have a key.
+    for (AUTO_VAR(it, structs_.vec.begin()); it != structs_.vec.end();
+         ++it) {
+      AUTO_VAR(&fields, (*it)->fields.vec);
+      for (AUTO_VAR(field, fields.begin()); field != fields.end(); ++field) {
+        CheckIndexField(**it, **field, "hash_index", BASE_TYPE_UINT, false);
+        CheckIndexField(**it, **field, "key_prefix", BASE_TYPE_ULONG, true);
+        if ((*field)->attributes.Lookup("eytzinger") &&
+            !IsKeyedTableVector(*field))
+          Error("eytzinger attribute may only apply to a vector of tables"
+                " with a key field: " + (*field)->name);
+      }
+    }
     for (AUTO_VAR(it, enums_.vec.begin()); it != enums_.vec.end(); ++it) {
       AUTO_VAR(&enum_def, **it);
       if (enum_def.is_union) {
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2015 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// independent from idl_parser, since this code is not needed for most clients
+
+#include "flatbuffers/flatbuffers.h"
+#include "flatbuffers/idl.h"
+
+namespace flatbuffers {
+
+static const uint32_t kNoTable = ~static_cast<uint32_t>(0);
+
+// Verifies the root table of a buffer, as passed to
+// Verifier::VerifyBufferWith().
+struct SchemaVerifier::CompiledRoot {
+  CompiledRoot(const SchemaVerifier *_schema, uint32_t _index)
+    : schema(_schema), index(_index) {}
+
+  bool operator()(Verifier &verifier, const uint8_t *root) const {
+    return schema->VerifyTable(verifier, root, index);
+  }
+
+  const SchemaVerifier *schema;
+  uint32_t index;
+};
+
+SchemaVerifier::SchemaVerifier(const Parser &parser, const StructDef *root) {
+  if (!root) root = parser.root_struct_def;
+  if (!root || root->fixed) return;
+  TableIndex(*root);
+  // Tables referred to are added to table_defs_ as they are found.
+  for (size_t i = 0; i < table_defs_.size(); i++) {
+    CompileTable(parser, *table_defs_[i]);
+  }
+  table_defs_.clear();
+  table_indices_.clear();
+  union_indices_.clear();
+}
+
+bool SchemaVerifier::VerifyBuffer(Verifier &verifier) const {
+  return ok() && verifier.VerifyBufferWith(CompiledRoot(this, 0));
+}
+
+bool SchemaVerifier::VerifySizePrefixedBuffer(Verifier &verifier) const {
+  return ok() && verifier.VerifySizePrefixedBufferWith(CompiledRoot(this, 0));
+}
+
+uint32_t SchemaVerifier::TableIndex(const StructDef &struct_def) {
+  AUTO_VAR(it, table_indices_.find(&struct_def));
+  if (it != table_indices_.end()) return it->second;
+  AUTO_VAR(index, static_cast<uint32_t>(table_defs_.size()));
+  table_indices_[&struct_def] = index;
+  table_defs_.push_back(&struct_def);
+  TableChecks checks = { 0, 0 };
+  tables_.push_back(checks);
+  return index;
+}
+
+uint32_t SchemaVerifier::UnionIndex(const EnumDef &enum_def) {
+  AUTO_VAR(it, union_indices_.find(&enum_def));
+  if (it != union_indices_.end()) return it->second;
+  AUTO_VAR(index, static_cast<uint32_t>(unions_.size()));
+  union_indices_[&enum_def] = index;
+  // Union types are stored as a ubyte.
+  uint32_t count = 0;
+  for (AUTO_VAR(it, enum_def.vals.vec.begin()); it != enum_def.vals.vec.end();
+       ++it) {
+    count = std::max(count, static_cast<uint32_t>((*it)->value + 1));
+  }
+  count = std::min(count, 256u);
+  unions_.push_back(count);
+  unions_.resize(unions_.size() + count, kNoTable);
+  for (AUTO_VAR(it, enum_def.vals.vec.begin()); it != enum_def.vals.vec.end();
+       ++it) {
+    AUTO_VAR(&ev, **it);
+    if (ev.value > 0 && ev.value < static_cast<int64_t>(count) &&
+        ev.struct_def)
+      unions_[index + 1 + ev.value] = TableIndex(*ev.struct_def);
+  }
+  return index;
+}
+
+void SchemaVerifier::CompileTable(const Parser &parser,
+                                  const StructDef &struct_def) {
+  // Not a reference: tables_ grows as tables referred to are found.
+  AUTO_VAR(index, table_indices_[&struct_def]);
+  tables_[index].begin = static_cast<uint32_t>(checks_.size());
+  for (AUTO_VAR(it, struct_def.fields.vec.begin());
+       it != struct_def.fields.vec.end();
+       ++it) {
+    AUTO_VAR(&field, **it);
+    if (field.deprecated) continue;  // Not verified by generated code either.
+    AUTO_VAR(&type, field.value.type);
+    FieldCheck check;
+    check.field = field.value.offset;
+    check.op = kScalar;
+    check.required = field.required;
+    check.size = static_cast<uint32_t>(IsScalar(type.base_type) ||
+                                       IsStruct(type)
+                                         ? InlineSize(type)
+                                         : sizeof(uoffset_t));
+    check.arg = 0;
+    check.target = 0;
+    check.name = static_cast<uint32_t>(names_.size());
+    names_.push_back(field.name);
+    switch (type.base_type) {
+      case BASE_TYPE_STRING:
+        check.op = kString;
+        break;
+      case BASE_TYPE_STRUCT:
+        if (!type.struct_def->fixed) {
+          check.op = kTable;
+          check.target = TableIndex(*type.struct_def);
+        }
+        break;
+      case BASE_TYPE_UNION: {
+        AUTO_VAR(type_field, struct_def.fields.Lookup(field.name + "_type"));
+        assert(type_field);  // Guaranteed to exist by parser.
+        check.op = kUnion;
+        check.arg = type_field->value.offset;
+        check.target = UnionIndex(*type.enum_def);
+        break;
+      }
+      case BASE_TYPE_VECTOR: {
+        AUTO_VAR(nested, field.attributes.Lookup("nested_flatbuffer"));
+        AUTO_VAR(nested_root, nested ? parser.structs_.Lookup(nested->constant)
+                                     : nullptr);
+        if (type.element == BASE_TYPE_STRING) {
+          check.op = kVectorOfStrings;
+        } else if (type.element == BASE_TYPE_STRUCT &&
+                   !type.struct_def->fixed) {
+          check.op = kVectorOfTables;
+          check.target = TableIndex(*type.struct_def);
+        } else if (nested_root && !nested_root->fixed) {
+          check.op = kNestedBuffer;
+          check.target = TableIndex(*nested_root);
+        } else {
+          check.op = kVector;
+          check.arg = static_cast<uint32_t>(InlineSize(type.VectorType()));
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    checks_.push_back(check);
+  }
+  tables_[index].end = static_cast<uint32_t>(checks_.size());
+}
+
+bool SchemaVerifier::VerifyTable(Verifier &verifier, const uint8_t *table,
+                                 uint32_t index) const {
+  AUTO_VAR(&checks, tables_[index]);
+  if (!table || verifier.IsVerified(table, &checks)) return true;
+  AUTO_VAR(t, reinterpret_cast<const Table *>(table));
+  if (!t->VerifyTableStart(verifier)) return false;
+  // The vtable is verified now, so fields can be looked up.
+  AUTO_VAR(vtable, table - ReadScalar<soffset_t>(table));
+  AUTO_VAR(vtsize, ReadScalar<voffset_t>(vtable));
+  for (AUTO_VAR(check, checks_.data() + checks.begin);
+       check != checks_.data() + checks.end; ++check) {
+    AUTO_VAR(field_offset, check->field < vtsize
+                             ? ReadScalar<voffset_t>(vtable + check->field)
+                             : 0);
+    if (!field_offset) {
+      if (check->required)
+        return verifier.Field(names_[check->name].c_str(),
+                              verifier.Check(false) || verifier.Fail(table));
+      continue;
+    }
+    if (!VerifyField(verifier, table, table + field_offset, *check))
+      return verifier.Field(names_[check->name].c_str(), false);
+  }
+  verifier.EndTable();
+  verifier.SetVerified(table, &checks);
+  return true;
+}
+
+bool SchemaVerifier::VerifyField(Verifier &verifier, const uint8_t *table,
+                                 const uint8_t *p,
+                                 const FieldCheck &check) const {
+  if (!verifier.Verify(p, check.size)) return false;
+  if (check.op == kScalar) return true;
+  AUTO_VAR(object, p + ReadScalar<uoffset_t>(p));
+  const uint8_t *end;
+  switch (check.op) {
+    case kString:
+      return verifier.Verify(reinterpret_cast<const String *>(object));
+    case kTable:
+      return VerifyTable(verifier, object, check.target);
+    case kUnion: {
+      AUTO_VAR(type, reinterpret_cast<const Table *>(table)->
+                       GetField<uint8_t>(static_cast<voffset_t>(check.arg),
+                                         0));
+      if (!type) return true;  // NONE.
+      AUTO_VAR(values, &unions_[check.target]);
+      AUTO_VAR(target, type < values[0] ? values[1 + type] : kNoTable);
+      if (target == kNoTable) return verifier.Fail(object);
+      return VerifyTable(verifier, object, target);
+    }
+    case kVector:
+      return verifier.VerifyVector(object, check.arg, &end);
+    case kVectorOfStrings: {
+      AUTO_VAR(vec, reinterpret_cast<const Vector<Offset<String> > *>(object));
+      return verifier.VerifyVector(object, sizeof(uoffset_t), &end) &&
+             verifier.VerifyVectorOfStrings(vec);
+    }
+    case kVectorOfTables: {
+      if (!verifier.VerifyVector(object, sizeof(uoffset_t), &end))
+        return false;
+      // Keyed apart from the tables themselves, see Verifier::IsVerified().
+      AUTO_VAR(key, reinterpret_cast<const uint8_t *>(&tables_[check.target]) +
+                    1);
+      if (verifier.IsVerified(object, key)) return true;
+      AUTO_VAR(vec, reinterpret_cast<const Vector<Offset<Table> > *>(object));
+      for (uoffset_t i = 0; i < vec->size(); i++) {
+        if (!VerifyTable(verifier, reinterpret_cast<const uint8_t *>(
+                                     vec->Get(i)), check.target))
+          return verifier.FailedElement(i);
+      }
+      verifier.SetVerified(object, key);
+      return true;
+    }
+    case kNestedBuffer: {
+      if (!verifier.VerifyVector(object, 1, &end)) return false;
+      AUTO_VAR(vec, reinterpret_cast<const Vector<uint8_t> *>(object));
+      return verifier.VerifyNestedBuffer(vec->Data(), vec->size(),
+                                         CompiledRoot(this, check.target));
+    }
+    default:
+      return false;
+  }
+}
+
+}  // namespace flatbuffers
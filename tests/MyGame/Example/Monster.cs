@@ -46,8 +46,18 @@ public class Monster : Table {
   public uint Testhashu32Fnv1a() { int o = __offset(46); return o != 0 ? bb.GetUint(o + bb_pos) : (uint)0; }
   public long Testhashs64Fnv1a() { int o = __offset(48); return o != 0 ? bb.GetLong(o + bb_pos) : (long)0; }
   public ulong Testhashu64Fnv1a() { int o = __offset(50); return o != 0 ? bb.GetUlong(o + bb_pos) : (ulong)0; }
+  /// hash index of testarrayoftables, see testarrayoftables_by_key()
+  public uint TestarrayoftablesIndex(int j) { int o = __offset(52); return o != 0 ? bb.GetUint(__vector(o) + j * 4) : (uint)0; }
+  public int TestarrayoftablesIndexLength() { int o = __offset(52); return o != 0 ? __vector_len(o) : 0; }
+  public Monster Testarrayofeytzingertables(int j) { return Testarrayofeytzingertables(new Monster(), j); }
+  public Monster Testarrayofeytzingertables(Monster obj, int j) { int o = __offset(54); return o != 0 ? obj.__init(__indirect(__vector(o) + j * 4), bb) : null; }
+  public int TestarrayofeytzingertablesLength() { int o = __offset(54); return o != 0 ? __vector_len(o) : 0; }
+  public ulong TestarrayoftablesPrefixes(int j) { int o = __offset(56); return o != 0 ? bb.GetUlong(__vector(o) + j * 8) : (ulong)0; }
+  public int TestarrayoftablesPrefixesLength() { int o = __offset(56); return o != 0 ? __vector_len(o) : 0; }
+  public ulong TestarrayofeytzingertablesPrefixes(int j) { int o = __offset(58); return o != 0 ? bb.GetUlong(__vector(o) + j * 8) : (ulong)0; }
+  public int TestarrayofeytzingertablesPrefixesLength() { int o = __offset(58); return o != 0 ? __vector_len(o) : 0; }
 
-  public static void StartMonster(FlatBufferBuilder builder) { builder.StartObject(24); }
+  public static void StartMonster(FlatBufferBuilder builder) { builder.StartObject(28); }
   public static void AddPos(FlatBufferBuilder builder, int posOffset) { builder.AddStruct(0, posOffset, 0); }
   public static void AddMana(FlatBufferBuilder builder, short mana) { builder.AddShort(1, mana, 150); }
   public static void AddHp(FlatBufferBuilder builder, short hp) { builder.AddShort(2, hp, 100); }
@@ -80,6 +90,18 @@ public class Monster : Table {
   public static void AddTesthashu32Fnv1a(FlatBufferBuilder builder, uint testhashu32Fnv1a) { builder.AddUint(21, testhashu32Fnv1a, 0); }
   public static void AddTesthashs64Fnv1a(FlatBufferBuilder builder, long testhashs64Fnv1a) { builder.AddLong(22, testhashs64Fnv1a, 0); }
   public static void AddTesthashu64Fnv1a(FlatBufferBuilder builder, ulong testhashu64Fnv1a) { builder.AddUlong(23, testhashu64Fnv1a, 0); }
+  public static void AddTestarrayoftablesIndex(FlatBufferBuilder builder, int testarrayoftablesIndexOffset) { builder.AddOffset(24, testarrayoftablesIndexOffset, 0); }
+  public static int CreateTestarrayoftablesIndexVector(FlatBufferBuilder builder, uint[] data) { builder.StartVector(4, data.Length, 4); for (int i = data.Length - 1; i >= 0; i--) builder.AddUint(data[i]); return builder.EndVector(); }
+  public static void StartTestarrayoftablesIndexVector(FlatBufferBuilder builder, int numElems) { builder.StartVector(4, numElems, 4); }
+  public static void AddTestarrayofeytzingertables(FlatBufferBuilder builder, int testarrayofeytzingertablesOffset) { builder.AddOffset(25, testarrayofeytzingertablesOffset, 0); }
+  public static int CreateTestarrayofeytzingertablesVector(FlatBufferBuilder builder, int[] data) { builder.StartVector(4, data.Length, 4); for (int i = data.Length - 1; i >= 0; i--) builder.AddOffset(data[i]); return builder.EndVector(); }
+  public static void StartTestarrayofeytzingertablesVector(FlatBufferBuilder builder, int numElems) { builder.StartVector(4, numElems, 4); }
+  public static void AddTestarrayoftablesPrefixes(FlatBufferBuilder builder, int testarrayoftablesPrefixesOffset) { builder.AddOffset(26, testarrayoftablesPrefixesOffset, 0); }
+  public static int CreateTestarrayoftablesPrefixesVector(FlatBufferBuilder builder, ulong[] data) { builder.StartVector(8, data.Length, 8); for (int i = data.Length - 1; i >= 0; i--) builder.AddUlong(data[i]); return builder.EndVector(); }
+  public static void StartTestarrayoftablesPrefixesVector(FlatBufferBuilder builder, int numElems) { builder.StartVector(8, numElems, 8); }
+  public static void AddTestarrayofeytzingertablesPrefixes(FlatBufferBuilder builder, int testarrayofeytzingertablesPrefixesOffset) { builder.AddOffset(27, testarrayofeytzingertablesPrefixesOffset, 0); }
+  public static int CreateTestarrayofeytzingertablesPrefixesVector(FlatBufferBuilder builder, ulong[] data) { builder.StartVector(8, data.Length, 8); for (int i = data.Length - 1; i >= 0; i--) builder.AddUlong(data[i]); return builder.EndVector(); }
+  public static void StartTestarrayofeytzingertablesPrefixesVector(FlatBufferBuilder builder, int numElems) { builder.StartVector(8, numElems, 8); }
   public static int EndMonster(FlatBufferBuilder builder) {
     int o = builder.EndObject();
     builder.Required(o, 10);  // name
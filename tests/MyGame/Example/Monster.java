@@ -51,8 +51,21 @@ public class Monster extends Table {
   public long testhashu32Fnv1a() { int o = __offset(46); return o != 0 ? (long)bb.getInt(o + bb_pos) & 0xFFFFFFFFL : 0; }
   public long testhashs64Fnv1a() { int o = __offset(48); return o != 0 ? bb.getLong(o + bb_pos) : 0; }
   public long testhashu64Fnv1a() { int o = __offset(50); return o != 0 ? bb.getLong(o + bb_pos) : 0; }
+  /// hash index of testarrayoftables, see testarrayoftables_by_key()
+  public long testarrayoftablesIndex(int j) { int o = __offset(52); return o != 0 ? (long)bb.getInt(__vector(o) + j * 4) & 0xFFFFFFFFL : 0; }
+  public int testarrayoftablesIndexLength() { int o = __offset(52); return o != 0 ? __vector_len(o) : 0; }
+  public ByteBuffer testarrayoftablesIndexAsByteBuffer() { return __vector_as_bytebuffer(52, 4); }
+  public Monster testarrayofeytzingertables(int j) { return testarrayofeytzingertables(new Monster(), j); }
+  public Monster testarrayofeytzingertables(Monster obj, int j) { int o = __offset(54); return o != 0 ? obj.__init(__indirect(__vector(o) + j * 4), bb) : null; }
+  public int testarrayofeytzingertablesLength() { int o = __offset(54); return o != 0 ? __vector_len(o) : 0; }
+  public long testarrayoftablesPrefixes(int j) { int o = __offset(56); return o != 0 ? bb.getLong(__vector(o) + j * 8) : 0; }
+  public int testarrayoftablesPrefixesLength() { int o = __offset(56); return o != 0 ? __vector_len(o) : 0; }
+  public ByteBuffer testarrayoftablesPrefixesAsByteBuffer() { return __vector_as_bytebuffer(56, 8); }
+  public long testarrayofeytzingertablesPrefixes(int j) { int o = __offset(58); return o != 0 ? bb.getLong(__vector(o) + j * 8) : 0; }
+  public int testarrayofeytzingertablesPrefixesLength() { int o = __offset(58); return o != 0 ? __vector_len(o) : 0; }
+  public ByteBuffer testarrayofeytzingertablesPrefixesAsByteBuffer() { return __vector_as_bytebuffer(58, 8); }
 
-  public static void startMonster(FlatBufferBuilder builder) { builder.startObject(24); }
+  public static void startMonster(FlatBufferBuilder builder) { builder.startObject(28); }
   public static void addPos(FlatBufferBuilder builder, int posOffset) { builder.addStruct(0, posOffset, 0); }
   public static void addMana(FlatBufferBuilder builder, short mana) { builder.addShort(1, mana, 150); }
   public static void addHp(FlatBufferBuilder builder, short hp) { builder.addShort(2, hp, 100); }
@@ -85,6 +98,18 @@ public class Monster extends Table {
   public static void addTesthashu32Fnv1a(FlatBufferBuilder builder, long testhashu32Fnv1a) { builder.addInt(21, (int)(testhashu32Fnv1a & 0xFFFFFFFFL), 0); }
   public static void addTesthashs64Fnv1a(FlatBufferBuilder builder, long testhashs64Fnv1a) { builder.addLong(22, testhashs64Fnv1a, 0); }
   public static void addTesthashu64Fnv1a(FlatBufferBuilder builder, long testhashu64Fnv1a) { builder.addLong(23, testhashu64Fnv1a, 0); }
+  public static void addTestarrayoftablesIndex(FlatBufferBuilder builder, int testarrayoftablesIndexOffset) { builder.addOffset(24, testarrayoftablesIndexOffset, 0); }
+  public static int createTestarrayoftablesIndexVector(FlatBufferBuilder builder, int[] data) { builder.startVector(4, data.length, 4); for (int i = data.length - 1; i >= 0; i--) builder.addInt(data[i]); return builder.endVector(); }
+  public static void startTestarrayoftablesIndexVector(FlatBufferBuilder builder, int numElems) { builder.startVector(4, numElems, 4); }
+  public static void addTestarrayofeytzingertables(FlatBufferBuilder builder, int testarrayofeytzingertablesOffset) { builder.addOffset(25, testarrayofeytzingertablesOffset, 0); }
+  public static int createTestarrayofeytzingertablesVector(FlatBufferBuilder builder, int[] data) { builder.startVector(4, data.length, 4); for (int i = data.length - 1; i >= 0; i--) builder.addOffset(data[i]); return builder.endVector(); }
+  public static void startTestarrayofeytzingertablesVector(FlatBufferBuilder builder, int numElems) { builder.startVector(4, numElems, 4); }
+  public static void addTestarrayoftablesPrefixes(FlatBufferBuilder builder, int testarrayoftablesPrefixesOffset) { builder.addOffset(26, testarrayoftablesPrefixesOffset, 0); }
+  public static int createTestarrayoftablesPrefixesVector(FlatBufferBuilder builder, long[] data) { builder.startVector(8, data.length, 8); for (int i = data.length - 1; i >= 0; i--) builder.addLong(data[i]); return builder.endVector(); }
+  public static void startTestarrayoftablesPrefixesVector(FlatBufferBuilder builder, int numElems) { builder.startVector(8, numElems, 8); }
+  public static void addTestarrayofeytzingertablesPrefixes(FlatBufferBuilder builder, int testarrayofeytzingertablesPrefixesOffset) { builder.addOffset(27, testarrayofeytzingertablesPrefixesOffset, 0); }
+  public static int createTestarrayofeytzingertablesPrefixesVector(FlatBufferBuilder builder, long[] data) { builder.startVector(8, data.length, 8); for (int i = data.length - 1; i >= 0; i--) builder.addLong(data[i]); return builder.endVector(); }
+  public static void startTestarrayofeytzingertablesPrefixesVector(FlatBufferBuilder builder, int numElems) { builder.startVector(8, numElems, 8); }
   public static int endMonster(FlatBufferBuilder builder) {
     int o = builder.endObject();
     builder.required(o, 10);  // name
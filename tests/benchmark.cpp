@@ -0,0 +1,145 @@
+/*
+ * Copyright 2015 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Timings of reading patterns over big buffers, to see what the techniques
+// in flatbuffers.h meant to speed them up gain on this machine, and of
+// verifying them with the generated code and with a SchemaVerifier.
+// Usage: flatbenchmark [number of tables]
+// Run from the directory containing tests/monster_test.fbs.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "flatbuffers/flatbuffers.h"
+#include "flatbuffers/idl.h"
+#include "flatbuffers/util.h"
+
+#include "monster_test_generated.h"
+
+using namespace MyGame::Example;
+
+// Run `f` a few times, and return the fastest time in nanoseconds per table.
+template<typename F> double Time(F f, size_t tables, int *result) {
+  double best = 0;
+  for (int run = 0; run < 5; run++) {
+    auto start = std::chrono::steady_clock::now();
+    *result = f();
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    if (!run || ns < best) best = ns;
+  }
+  return best / tables;
+}
+
+// Monsters as they'd appear in a typical big buffer: not stored in the
+// order they're listed in, so a scan jumps around memory.
+std::vector<uint8_t> BuildMonsters(int count) {
+  flatbuffers::FlatBufferBuilder fbb;
+  std::vector<flatbuffers::Offset<Monster>> monsters(count);
+  std::vector<int> order(count);
+  for (int i = 0; i < count; i++) order[i] = i;
+  uint32_t seed = 42;
+  for (int i = count - 1; i > 0; i--) {
+    seed = seed * 1664525 + 1013904223;
+    std::swap(order[i], order[(seed >> 8) % (i + 1)]);
+  }
+  uint8_t inventory[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  for (int i = 0; i < count; i++) {
+    auto name = fbb.CreateString("Monster" + flatbuffers::NumToString(i));
+    auto inv = fbb.CreateVector(inventory, sizeof(inventory));
+    Vec3 pos(1, 2, 3, 0, Color_Red, Test(10, 20));
+    monsters[order[i]] = CreateMonster(fbb, &pos, static_cast<int16_t>(i),
+                                       static_cast<int16_t>(i), name, inv);
+  }
+  auto name = fbb.CreateString("MyMonster");
+  auto tables = fbb.CreateVector(monsters);
+  MonsterBuilder mb(fbb);
+  mb.add_name(name);
+  mb.add_testarrayoftables(tables);
+  FinishMonsterBuffer(fbb, mb.Finish());
+  return std::vector<uint8_t>(fbb.GetBufferPointer(),
+                              fbb.GetBufferPointer() + fbb.GetSize());
+}
+
+struct SumFields {
+  SumFields() : sum(0) {}
+  void operator()(const Monster *monster) {
+    sum += monster->hp() + monster->mana();
+  }
+  int sum;
+};
+
+int main(int argc, const char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  auto buf = BuildMonsters(count);
+  auto tables = GetMonster(buf.data())->testarrayoftables();
+  printf("%d tables in a %d byte buffer, ns per table:\n", count,
+         static_cast<int>(buf.size()));
+
+  int expected;
+  auto ns = Time([&]() {
+    int sum = 0;
+    for (auto it = tables->begin(); it != tables->end(); ++it)
+      sum += it->hp() + it->mana();
+    return sum;
+  }, tables->size(), &expected);
+  printf("  iterator:              %6.2f\n", ns);
+
+  flatbuffers::uoffset_t distances[] = { 0, 4, 8, 16, 32 };
+  for (size_t d = 0; d < sizeof(distances) / sizeof(distances[0]); d++) {
+    int sum;
+    ns = Time([&]() {
+      return flatbuffers::ForEachPrefetch(tables, SumFields(),
+                                          distances[d]).sum;
+    }, tables->size(), &sum);
+    if (sum != expected) {
+      printf("ForEachPrefetch gave a different result\n");
+      return 1;
+    }
+    printf("  ForEachPrefetch(%2d):   %6.2f\n",
+           static_cast<int>(distances[d]), ns);
+  }
+
+  std::string schemafile;
+  flatbuffers::Parser parser;
+  const char *include_directories[] = { "tests", nullptr };
+  if (!flatbuffers::LoadFile("tests/monster_test.fbs", false, &schemafile) ||
+      !parser.Parse(schemafile.c_str(), include_directories)) {
+    printf("unable to load tests/monster_test.fbs\n");
+    return 1;
+  }
+  flatbuffers::SchemaVerifier schema(parser);
+  // All tables, and the root, within the max tables.
+  AUTO_VAR(max_tables, static_cast<size_t>(count) + 1);
+  int generated_ok;
+  ns = Time([&]() {
+    flatbuffers::Verifier verifier(buf.data(), buf.size(), 64, max_tables);
+    return static_cast<int>(VerifyMonsterBuffer(verifier));
+  }, tables->size(), &generated_ok);
+  printf("  generated Verify:      %6.2f\n", ns);
+  int schema_ok;
+  ns = Time([&]() {
+    flatbuffers::Verifier verifier(buf.data(), buf.size(), 64, max_tables);
+    return static_cast<int>(schema.VerifyBuffer(verifier));
+  }, tables->size(), &schema_ok);
+  if (!generated_ok || !schema_ok) {
+    printf("the buffer didn't verify\n");
+    return 1;
+  }
+  printf("  SchemaVerifier:        %6.2f\n", ns);
+  return 0;
+}
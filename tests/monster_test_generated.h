@@ -58,6 +58,10 @@ MANUALLY_ALIGNED_STRUCT(2) Test FLATBUFFERS_FINAL_CLASS {
 
   int16_t a() const { return flatbuffers::EndianScalar(a_); }
   int8_t b() const { return flatbuffers::EndianScalar(b_); }
+  enum {
+    OFFSET_A = 0,
+    OFFSET_B = 2
+  };
 };
 STRUCT_END(Test, 4);
 
@@ -83,23 +87,43 @@ MANUALLY_ALIGNED_STRUCT(16) Vec3 FLATBUFFERS_FINAL_CLASS {
   double test1() const { return flatbuffers::EndianScalar(test1_); }
   Color test2() const { return static_cast<Color>(flatbuffers::EndianScalar(test2_)); }
   const Test &test3() const { return test3_; }
+  enum {
+    OFFSET_X = 0,
+    OFFSET_Y = 4,
+    OFFSET_Z = 8,
+    OFFSET_TEST1 = 16,
+    OFFSET_TEST2 = 24,
+    OFFSET_TEST3 = 26
+  };
 };
 STRUCT_END(Vec3, 32);
 
 struct Stat FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const flatbuffers::String *id() const { return GetPointer<const flatbuffers::String *>(4); }
+  const flatbuffers::String *id(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::String *>(this, 4); }
   int64_t val() const { return GetField<int64_t>(6, 0); }
+  int64_t val(flatbuffers::Verifier &verifier) const { return verifier.GetField<int64_t>(this, 6, 0); }
   uint16_t count() const { return GetField<uint16_t>(8, 0); }
+  uint16_t count(flatbuffers::Verifier &verifier) const { return verifier.GetField<uint16_t>(this, 8, 0); }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 4 /* id */) &&
-           verifier.Verify(id()) &&
-           VerifyField<int64_t>(verifier, 6 /* val */) &&
-           VerifyField<uint16_t>(verifier, 8 /* count */) &&
+           verifier.Field("id", VerifyField<flatbuffers::uoffset_t>(verifier, 4) &&
+                                verifier.Verify(id())) &&
+           verifier.Field("val", VerifyField<int64_t>(verifier, 6)) &&
+           verifier.Field("count", VerifyField<uint16_t>(verifier, 8)) &&
            verifier.EndTable();
   }
 };
 
+struct StatView : public flatbuffers::TableView<3> {
+  StatView() {}
+  explicit StatView(const Stat *table) : flatbuffers::TableView<3>(table) {}
+  void Reset(const Stat *table) { flatbuffers::TableView<3>::Reset(table); }
+  const flatbuffers::String *id() const { return GetPointer<const flatbuffers::String *>(4); }
+  int64_t val() const { return GetField<int64_t>(6, 0); }
+  uint16_t count() const { return GetField<uint16_t>(8, 0); }
+};
+
 struct StatBuilder {
   flatbuffers::FlatBufferBuilder &fbb_;
   flatbuffers::uoffset_t start_;
@@ -127,73 +151,161 @@ inline flatbuffers::Offset<Stat> CreateStat(flatbuffers::FlatBufferBuilder &_fbb
 
 struct Monster FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const Vec3 *pos() const { return GetStruct<const Vec3 *>(4); }
+  const Vec3 *pos(flatbuffers::Verifier &verifier) const { return verifier.GetStruct<const Vec3 *>(this, 4); }
   int16_t mana() const { return GetField<int16_t>(6, 150); }
+  int16_t mana(flatbuffers::Verifier &verifier) const { return verifier.GetField<int16_t>(this, 6, 150); }
   int16_t hp() const { return GetField<int16_t>(8, 100); }
+  int16_t hp(flatbuffers::Verifier &verifier) const { return verifier.GetField<int16_t>(this, 8, 100); }
   const flatbuffers::String *name() const { return GetPointer<const flatbuffers::String *>(10); }
+  const flatbuffers::String *name(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::String *>(this, 10); }
   bool KeyCompareLessThan(const Monster *o) const { return *name() < *o->name(); }
   int KeyCompareWithValue(const char *val) const { return strcmp(name()->c_str(), val); }
+  uint32_t KeyHash() const { return flatbuffers::HashKey(name()->c_str()); }
+  uint64_t KeyPrefix() const { return flatbuffers::KeyPrefix(name()->c_str()); }
   const flatbuffers::Vector<uint8_t> *inventory() const { return GetPointer<const flatbuffers::Vector<uint8_t> *>(14); }
+  const flatbuffers::Vector<uint8_t> *inventory(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::Vector<uint8_t> *>(this, 14); }
   Color color() const { return static_cast<Color>(GetField<int8_t>(16, 8)); }
+  Color color(flatbuffers::Verifier &verifier) const { return static_cast<Color>(verifier.GetField<int8_t>(this, 16, 8)); }
   Any test_type() const { return static_cast<Any>(GetField<uint8_t>(18, 0)); }
+  Any test_type(flatbuffers::Verifier &verifier) const { return static_cast<Any>(verifier.GetField<uint8_t>(this, 18, 0)); }
   const void *test() const { return GetPointer<const void *>(20); }
+  const void *test(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const void *>(this, 20); }
   const flatbuffers::Vector<const Test *> *test4() const { return GetPointer<const flatbuffers::Vector<const Test *> *>(22); }
+  const flatbuffers::Vector<const Test *> *test4(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::Vector<const Test *> *>(this, 22); }
   const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *testarrayofstring() const { return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *>(24); }
+  const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *testarrayofstring(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *>(this, 24); }
   /// an example documentation comment: this will end up in the generated code
   /// multiline too
   const flatbuffers::Vector<flatbuffers::Offset<Monster>> *testarrayoftables() const { return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Monster>> *>(26); }
+  const flatbuffers::Vector<flatbuffers::Offset<Monster>> *testarrayoftables(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Monster>> *>(this, 26); }
   const Monster *enemy() const { return GetPointer<const Monster *>(28); }
+  const Monster *enemy(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const Monster *>(this, 28); }
   const flatbuffers::Vector<uint8_t> *testnestedflatbuffer() const { return GetPointer<const flatbuffers::Vector<uint8_t> *>(30); }
+  const flatbuffers::Vector<uint8_t> *testnestedflatbuffer(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::Vector<uint8_t> *>(this, 30); }
   const Monster *testnestedflatbuffer_nested_root() const { return flatbuffers::GetRoot<Monster>(testnestedflatbuffer()->Data()); }
   const Stat *testempty() const { return GetPointer<const Stat *>(32); }
+  const Stat *testempty(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const Stat *>(this, 32); }
   uint8_t testbool() const { return GetField<uint8_t>(34, 0); }
+  uint8_t testbool(flatbuffers::Verifier &verifier) const { return verifier.GetField<uint8_t>(this, 34, 0); }
   int32_t testhashs32_fnv1() const { return GetField<int32_t>(36, 0); }
+  int32_t testhashs32_fnv1(flatbuffers::Verifier &verifier) const { return verifier.GetField<int32_t>(this, 36, 0); }
   uint32_t testhashu32_fnv1() const { return GetField<uint32_t>(38, 0); }
+  uint32_t testhashu32_fnv1(flatbuffers::Verifier &verifier) const { return verifier.GetField<uint32_t>(this, 38, 0); }
   int64_t testhashs64_fnv1() const { return GetField<int64_t>(40, 0); }
+  int64_t testhashs64_fnv1(flatbuffers::Verifier &verifier) const { return verifier.GetField<int64_t>(this, 40, 0); }
   uint64_t testhashu64_fnv1() const { return GetField<uint64_t>(42, 0); }
+  uint64_t testhashu64_fnv1(flatbuffers::Verifier &verifier) const { return verifier.GetField<uint64_t>(this, 42, 0); }
   int32_t testhashs32_fnv1a() const { return GetField<int32_t>(44, 0); }
+  int32_t testhashs32_fnv1a(flatbuffers::Verifier &verifier) const { return verifier.GetField<int32_t>(this, 44, 0); }
   uint32_t testhashu32_fnv1a() const { return GetField<uint32_t>(46, 0); }
+  uint32_t testhashu32_fnv1a(flatbuffers::Verifier &verifier) const { return verifier.GetField<uint32_t>(this, 46, 0); }
   int64_t testhashs64_fnv1a() const { return GetField<int64_t>(48, 0); }
+  int64_t testhashs64_fnv1a(flatbuffers::Verifier &verifier) const { return verifier.GetField<int64_t>(this, 48, 0); }
   uint64_t testhashu64_fnv1a() const { return GetField<uint64_t>(50, 0); }
+  uint64_t testhashu64_fnv1a(flatbuffers::Verifier &verifier) const { return verifier.GetField<uint64_t>(this, 50, 0); }
+  /// hash index of testarrayoftables, see testarrayoftables_by_key()
+  const flatbuffers::Vector<uint32_t> *testarrayoftables_index() const { return GetPointer<const flatbuffers::Vector<uint32_t> *>(52); }
+  const flatbuffers::Vector<uint32_t> *testarrayoftables_index(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::Vector<uint32_t> *>(this, 52); }
+  const flatbuffers::Vector<flatbuffers::Offset<Monster>> *testarrayofeytzingertables() const { return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Monster>> *>(54); }
+  const flatbuffers::Vector<flatbuffers::Offset<Monster>> *testarrayofeytzingertables(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Monster>> *>(this, 54); }
+  const flatbuffers::Vector<uint64_t> *testarrayoftables_prefixes() const { return GetPointer<const flatbuffers::Vector<uint64_t> *>(56); }
+  const flatbuffers::Vector<uint64_t> *testarrayoftables_prefixes(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::Vector<uint64_t> *>(this, 56); }
+  const flatbuffers::Vector<uint64_t> *testarrayofeytzingertables_prefixes() const { return GetPointer<const flatbuffers::Vector<uint64_t> *>(58); }
+  const flatbuffers::Vector<uint64_t> *testarrayofeytzingertables_prefixes(flatbuffers::Verifier &verifier) const { return verifier.GetPointer<const flatbuffers::Vector<uint64_t> *>(this, 58); }
+  const Monster *testarrayoftables_by_key(const char *key) const {
+    auto v = testarrayoftables();
+    if (!v) return nullptr;
+    auto index = testarrayoftables_index();
+    if (index && index->size()) return v->LookupByKey(key, index);
+    return v->LookupByKeyPrefix(key, testarrayoftables_prefixes(), false);
+  }
+  const Monster *testarrayofeytzingertables_by_key(const char *key) const {
+    auto v = testarrayofeytzingertables();
+    if (!v) return nullptr;
+    return v->LookupByKeyPrefix(key, testarrayofeytzingertables_prefixes(), true);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
-           VerifyField<Vec3>(verifier, 4 /* pos */) &&
-           VerifyField<int16_t>(verifier, 6 /* mana */) &&
-           VerifyField<int16_t>(verifier, 8 /* hp */) &&
-           VerifyFieldRequired<flatbuffers::uoffset_t>(verifier, 10 /* name */) &&
-           verifier.Verify(name()) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 14 /* inventory */) &&
-           verifier.Verify(inventory()) &&
-           VerifyField<int8_t>(verifier, 16 /* color */) &&
-           VerifyField<uint8_t>(verifier, 18 /* test_type */) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 20 /* test */) &&
-           VerifyAny(verifier, test(), test_type()) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 22 /* test4 */) &&
-           verifier.Verify(test4()) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 24 /* testarrayofstring */) &&
-           verifier.Verify(testarrayofstring()) &&
-           verifier.VerifyVectorOfStrings(testarrayofstring()) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 26 /* testarrayoftables */) &&
-           verifier.Verify(testarrayoftables()) &&
-           verifier.VerifyVectorOfTables(testarrayoftables()) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 28 /* enemy */) &&
-           verifier.VerifyTable(enemy()) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 30 /* testnestedflatbuffer */) &&
-           verifier.Verify(testnestedflatbuffer()) &&
-           VerifyField<flatbuffers::uoffset_t>(verifier, 32 /* testempty */) &&
-           verifier.VerifyTable(testempty()) &&
-           VerifyField<uint8_t>(verifier, 34 /* testbool */) &&
-           VerifyField<int32_t>(verifier, 36 /* testhashs32_fnv1 */) &&
-           VerifyField<uint32_t>(verifier, 38 /* testhashu32_fnv1 */) &&
-           VerifyField<int64_t>(verifier, 40 /* testhashs64_fnv1 */) &&
-           VerifyField<uint64_t>(verifier, 42 /* testhashu64_fnv1 */) &&
-           VerifyField<int32_t>(verifier, 44 /* testhashs32_fnv1a */) &&
-           VerifyField<uint32_t>(verifier, 46 /* testhashu32_fnv1a */) &&
-           VerifyField<int64_t>(verifier, 48 /* testhashs64_fnv1a */) &&
-           VerifyField<uint64_t>(verifier, 50 /* testhashu64_fnv1a */) &&
+           verifier.Field("pos", VerifyField<Vec3>(verifier, 4)) &&
+           verifier.Field("mana", VerifyField<int16_t>(verifier, 6)) &&
+           verifier.Field("hp", VerifyField<int16_t>(verifier, 8)) &&
+           verifier.Field("name", VerifyFieldRequired<flatbuffers::uoffset_t>(verifier, 10) &&
+                                  verifier.Verify(name())) &&
+           verifier.Field("inventory", VerifyField<flatbuffers::uoffset_t>(verifier, 14) &&
+                                       verifier.Verify(inventory())) &&
+           verifier.Field("color", VerifyField<int8_t>(verifier, 16)) &&
+           verifier.Field("test_type", VerifyField<uint8_t>(verifier, 18)) &&
+           verifier.Field("test", VerifyField<flatbuffers::uoffset_t>(verifier, 20) &&
+                                  VerifyAny(verifier, test(), test_type())) &&
+           verifier.Field("test4", VerifyField<flatbuffers::uoffset_t>(verifier, 22) &&
+                                   verifier.Verify(test4())) &&
+           verifier.Field("testarrayofstring", VerifyField<flatbuffers::uoffset_t>(verifier, 24) &&
+                                               verifier.Verify(testarrayofstring()) &&
+                                               verifier.VerifyVectorOfStrings(testarrayofstring())) &&
+           verifier.Field("testarrayoftables", VerifyField<flatbuffers::uoffset_t>(verifier, 26) &&
+                                               verifier.Verify(testarrayoftables()) &&
+                                               verifier.VerifyVectorOfTables(testarrayoftables())) &&
+           verifier.Field("enemy", VerifyField<flatbuffers::uoffset_t>(verifier, 28) &&
+                                   verifier.VerifyTable(enemy())) &&
+           verifier.Field("testnestedflatbuffer", VerifyField<flatbuffers::uoffset_t>(verifier, 30) &&
+                                                  verifier.Verify(testnestedflatbuffer())) &&
+           verifier.Field("testempty", VerifyField<flatbuffers::uoffset_t>(verifier, 32) &&
+                                       verifier.VerifyTable(testempty())) &&
+           verifier.Field("testbool", VerifyField<uint8_t>(verifier, 34)) &&
+           verifier.Field("testhashs32_fnv1", VerifyField<int32_t>(verifier, 36)) &&
+           verifier.Field("testhashu32_fnv1", VerifyField<uint32_t>(verifier, 38)) &&
+           verifier.Field("testhashs64_fnv1", VerifyField<int64_t>(verifier, 40)) &&
+           verifier.Field("testhashu64_fnv1", VerifyField<uint64_t>(verifier, 42)) &&
+           verifier.Field("testhashs32_fnv1a", VerifyField<int32_t>(verifier, 44)) &&
+           verifier.Field("testhashu32_fnv1a", VerifyField<uint32_t>(verifier, 46)) &&
+           verifier.Field("testhashs64_fnv1a", VerifyField<int64_t>(verifier, 48)) &&
+           verifier.Field("testhashu64_fnv1a", VerifyField<uint64_t>(verifier, 50)) &&
+           verifier.Field("testarrayoftables_index", VerifyField<flatbuffers::uoffset_t>(verifier, 52) &&
+                                                     verifier.Verify(testarrayoftables_index())) &&
+           verifier.Field("testarrayofeytzingertables", VerifyField<flatbuffers::uoffset_t>(verifier, 54) &&
+                                                        verifier.Verify(testarrayofeytzingertables()) &&
+                                                        verifier.VerifyVectorOfTables(testarrayofeytzingertables())) &&
+           verifier.Field("testarrayoftables_prefixes", VerifyField<flatbuffers::uoffset_t>(verifier, 56) &&
+                                                        verifier.Verify(testarrayoftables_prefixes())) &&
+           verifier.Field("testarrayofeytzingertables_prefixes", VerifyField<flatbuffers::uoffset_t>(verifier, 58) &&
+                                                                 verifier.Verify(testarrayofeytzingertables_prefixes())) &&
            verifier.EndTable();
   }
 };
 
+struct MonsterView : public flatbuffers::TableView<28> {
+  MonsterView() {}
+  explicit MonsterView(const Monster *table) : flatbuffers::TableView<28>(table) {}
+  void Reset(const Monster *table) { flatbuffers::TableView<28>::Reset(table); }
+  const Vec3 *pos() const { return GetStruct<const Vec3 *>(4); }
+  int16_t mana() const { return GetField<int16_t>(6, 150); }
+  int16_t hp() const { return GetField<int16_t>(8, 100); }
+  const flatbuffers::String *name() const { return GetPointer<const flatbuffers::String *>(10); }
+  const flatbuffers::Vector<uint8_t> *inventory() const { return GetPointer<const flatbuffers::Vector<uint8_t> *>(14); }
+  Color color() const { return static_cast<Color>(GetField<int8_t>(16, 8)); }
+  Any test_type() const { return static_cast<Any>(GetField<uint8_t>(18, 0)); }
+  const void *test() const { return GetPointer<const void *>(20); }
+  const flatbuffers::Vector<const Test *> *test4() const { return GetPointer<const flatbuffers::Vector<const Test *> *>(22); }
+  const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *testarrayofstring() const { return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *>(24); }
+  const flatbuffers::Vector<flatbuffers::Offset<Monster>> *testarrayoftables() const { return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Monster>> *>(26); }
+  const Monster *enemy() const { return GetPointer<const Monster *>(28); }
+  const flatbuffers::Vector<uint8_t> *testnestedflatbuffer() const { return GetPointer<const flatbuffers::Vector<uint8_t> *>(30); }
+  const Stat *testempty() const { return GetPointer<const Stat *>(32); }
+  uint8_t testbool() const { return GetField<uint8_t>(34, 0); }
+  int32_t testhashs32_fnv1() const { return GetField<int32_t>(36, 0); }
+  uint32_t testhashu32_fnv1() const { return GetField<uint32_t>(38, 0); }
+  int64_t testhashs64_fnv1() const { return GetField<int64_t>(40, 0); }
+  uint64_t testhashu64_fnv1() const { return GetField<uint64_t>(42, 0); }
+  int32_t testhashs32_fnv1a() const { return GetField<int32_t>(44, 0); }
+  uint32_t testhashu32_fnv1a() const { return GetField<uint32_t>(46, 0); }
+  int64_t testhashs64_fnv1a() const { return GetField<int64_t>(48, 0); }
+  uint64_t testhashu64_fnv1a() const { return GetField<uint64_t>(50, 0); }
+  const flatbuffers::Vector<uint32_t> *testarrayoftables_index() const { return GetPointer<const flatbuffers::Vector<uint32_t> *>(52); }
+  const flatbuffers::Vector<flatbuffers::Offset<Monster>> *testarrayofeytzingertables() const { return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Monster>> *>(54); }
+  const flatbuffers::Vector<uint64_t> *testarrayoftables_prefixes() const { return GetPointer<const flatbuffers::Vector<uint64_t> *>(56); }
+  const flatbuffers::Vector<uint64_t> *testarrayofeytzingertables_prefixes() const { return GetPointer<const flatbuffers::Vector<uint64_t> *>(58); }
+};
+
 struct MonsterBuilder {
   flatbuffers::FlatBufferBuilder &fbb_;
   flatbuffers::uoffset_t start_;
@@ -220,10 +332,14 @@ struct MonsterBuilder {
   void add_testhashu32_fnv1a(uint32_t testhashu32_fnv1a) { fbb_.AddElement<uint32_t>(46, testhashu32_fnv1a, 0); }
   void add_testhashs64_fnv1a(int64_t testhashs64_fnv1a) { fbb_.AddElement<int64_t>(48, testhashs64_fnv1a, 0); }
   void add_testhashu64_fnv1a(uint64_t testhashu64_fnv1a) { fbb_.AddElement<uint64_t>(50, testhashu64_fnv1a, 0); }
+  void add_testarrayoftables_index(flatbuffers::Offset<flatbuffers::Vector<uint32_t>> testarrayoftables_index) { fbb_.AddOffset(52, testarrayoftables_index); }
+  void add_testarrayofeytzingertables(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Monster>>> testarrayofeytzingertables) { fbb_.AddOffset(54, testarrayofeytzingertables); }
+  void add_testarrayoftables_prefixes(flatbuffers::Offset<flatbuffers::Vector<uint64_t>> testarrayoftables_prefixes) { fbb_.AddOffset(56, testarrayoftables_prefixes); }
+  void add_testarrayofeytzingertables_prefixes(flatbuffers::Offset<flatbuffers::Vector<uint64_t>> testarrayofeytzingertables_prefixes) { fbb_.AddOffset(58, testarrayofeytzingertables_prefixes); }
   MonsterBuilder(flatbuffers::FlatBufferBuilder &_fbb) : fbb_(_fbb) { start_ = fbb_.StartTable(); }
   MonsterBuilder &operator=(const MonsterBuilder &);
   flatbuffers::Offset<Monster> Finish() {
-    auto o = flatbuffers::Offset<Monster>(fbb_.EndTable(start_, 24));
+    auto o = flatbuffers::Offset<Monster>(fbb_.EndTable(start_, 28));
     fbb_.Required(o, 10);  // name
     return o;
   }
@@ -252,12 +368,20 @@ inline flatbuffers::Offset<Monster> CreateMonster(flatbuffers::FlatBufferBuilder
    int32_t testhashs32_fnv1a = 0,
    uint32_t testhashu32_fnv1a = 0,
    int64_t testhashs64_fnv1a = 0,
-   uint64_t testhashu64_fnv1a = 0) {
+   uint64_t testhashu64_fnv1a = 0,
+   flatbuffers::Offset<flatbuffers::Vector<uint32_t>> testarrayoftables_index = 0,
+   flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Monster>>> testarrayofeytzingertables = 0,
+   flatbuffers::Offset<flatbuffers::Vector<uint64_t>> testarrayoftables_prefixes = 0,
+   flatbuffers::Offset<flatbuffers::Vector<uint64_t>> testarrayofeytzingertables_prefixes = 0) {
   MonsterBuilder builder_(_fbb);
   builder_.add_testhashu64_fnv1a(testhashu64_fnv1a);
   builder_.add_testhashs64_fnv1a(testhashs64_fnv1a);
   builder_.add_testhashu64_fnv1(testhashu64_fnv1);
   builder_.add_testhashs64_fnv1(testhashs64_fnv1);
+  builder_.add_testarrayofeytzingertables_prefixes(testarrayofeytzingertables_prefixes);
+  builder_.add_testarrayoftables_prefixes(testarrayoftables_prefixes);
+  builder_.add_testarrayofeytzingertables(testarrayofeytzingertables);
+  builder_.add_testarrayoftables_index(testarrayoftables_index);
   builder_.add_testhashu32_fnv1a(testhashu32_fnv1a);
   builder_.add_testhashs32_fnv1a(testhashs32_fnv1a);
   builder_.add_testhashu32_fnv1(testhashu32_fnv1);
@@ -284,20 +408,26 @@ inline bool VerifyAny(flatbuffers::Verifier &verifier, const void *union_obj, An
   switch (type) {
     case Any_NONE: return true;
     case Any_Monster: return verifier.VerifyTable(reinterpret_cast<const Monster *>(union_obj));
-    default: return false;
+    default: return verifier.Fail(union_obj);
   }
 }
 
 inline const Monster *GetMonster(const void *buf) { return flatbuffers::GetRoot<Monster>(buf); }
 
+inline const Monster *GetSizePrefixedMonster(const void *buf) { return flatbuffers::GetSizePrefixedRoot<Monster>(buf); }
+
 inline bool VerifyMonsterBuffer(flatbuffers::Verifier &verifier) { return verifier.VerifyBuffer<Monster>(); }
 
+inline bool VerifySizePrefixedMonsterBuffer(flatbuffers::Verifier &verifier) { return verifier.VerifySizePrefixedBuffer<Monster>(); }
+
 inline const char *MonsterIdentifier() { return "MONS"; }
 
 inline bool MonsterBufferHasIdentifier(const void *buf) { return flatbuffers::BufferHasIdentifier(buf, MonsterIdentifier()); }
 
 inline void FinishMonsterBuffer(flatbuffers::FlatBufferBuilder &fbb, flatbuffers::Offset<Monster> root) { fbb.Finish(root, MonsterIdentifier()); }
 
+inline void FinishSizePrefixedMonsterBuffer(flatbuffers::FlatBufferBuilder &fbb, flatbuffers::Offset<Monster> root) { fbb.FinishSizePrefixed(root, MonsterIdentifier()); }
+
 }  // namespace Example
 }  // namespace MyGame
 
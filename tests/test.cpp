@@ -14,13 +14,21 @@
  * limitations under the License.
  */
 
+#include "flatbuffers/archive.h"
+#include "flatbuffers/builder_pool.h"
 #include "flatbuffers/flatbuffers.h"
 #include "flatbuffers/idl.h"
+#include "flatbuffers/stream.h"
+#include "flatbuffers/thread_pool.h"
 #include "flatbuffers/util.h"
+#include "flatbuffers/vector_kernels.h"
 
 #include "monster_test_generated.h"
 
+#include <atomic>
+#include <new>
 #include <random>
+#include <thread>
 
 using namespace MyGame::Example;
 
@@ -203,6 +211,1478 @@ void AccessFlatBufferTest(const uint8_t *flatbuf, const std::size_t length) {
 
 }
 
+// Counts what's allocated with the global operator new, for tests of what
+// shouldn't allocate. Deleting isn't inlined, so compilers don't take free()
+// for a mismatch with new.
+std::atomic<size_t> num_allocations(0);
+
+void *operator new(size_t size) {
+  num_allocations++;
+  auto p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+FLATBUFFERS_NOINLINE void operator delete(void *p) throw() { free(p); }
+
+// Allocator that counts the blocks it hands out.
+class CountingAllocator : public flatbuffers::DefaultAllocator {
+ public:
+  CountingAllocator() : allocations(0), deallocations(0) {}
+  uint8_t *allocate(size_t size) {
+    allocations++;
+    return DefaultAllocator::allocate(size);
+  }
+  void deallocate(uint8_t *p, size_t size) {
+    deallocations++;
+    DefaultAllocator::deallocate(p, size);
+  }
+  int allocations;
+  int deallocations;
+};
+
+// Allocator written for the interface from before Allocator.
+class LegacyAllocator : public flatbuffers::simple_allocator {
+ public:
+  LegacyAllocator() : allocations(0), deallocations(0) {}
+  uint8_t *allocate(size_t size) const {
+    allocations++;
+    return simple_allocator::allocate(size);
+  }
+  void deallocate(uint8_t *p) const {
+    deallocations++;
+    simple_allocator::deallocate(p);
+  }
+  mutable int allocations;
+  mutable int deallocations;
+};
+
+// Builds a monster big enough to make a small initial buffer grow a few times.
+void CreateAllocatorTestMonster(flatbuffers::FlatBufferBuilder &builder) {
+  unsigned char inv_data[1000];
+  for (int i = 0; i < 1000; i++) inv_data[i] = static_cast<unsigned char>(i);
+  auto name = builder.CreateString("SlabMonster");
+  auto inventory = builder.CreateVector(inv_data, 1000);
+  auto mloc = CreateMonster(builder, nullptr, 150, 80, name, inventory);
+  FinishMonsterBuffer(builder, mloc);
+}
+
+void AllocatorTest() {
+  // Blocks released to a SlabAllocator are recycled, so once warmed up,
+  // encoding doesn't touch the heap anymore.
+  flatbuffers::SlabAllocator slab;
+  size_t warm_allocations = 0;
+  for (int i = 0; i < 4; i++) {
+    flatbuffers::FlatBufferBuilder builder(64, &slab);
+    CreateAllocatorTestMonster(builder);
+    flatbuffers::Verifier verifier(builder.GetBufferPointer(),
+                                   builder.GetSize());
+    TEST_EQ(VerifyMonsterBuffer(verifier), true);
+    TEST_EQ(GetMonster(builder.GetBufferPointer())->inventory()->Get(999),
+            static_cast<unsigned char>(999));
+    if (!i) warm_allocations = slab.heap_allocations();
+    TEST_EQ(slab.heap_allocations(), warm_allocations);
+  }
+  TEST_EQ(slab.cached_bytes() > 0, true);
+  {
+    // Released buffers go back to the pool once freed.
+    flatbuffers::FlatBufferBuilder builder(64, &slab);
+    CreateAllocatorTestMonster(builder);
+    auto released = builder.ReleaseBufferPointer();
+    TEST_EQ(GetMonster(released.get())->hp(), 80);
+  }
+  TEST_EQ(slab.heap_allocations(), warm_allocations);
+  slab.Trim();
+  TEST_EQ(slab.cached_bytes(), 0UL);
+
+  // With Reserve(), the buffer is allocated exactly once.
+  CountingAllocator counting;
+  flatbuffers::FlatBufferBuilder builder(64, &counting);
+  builder.Reserve(2048);
+  TEST_EQ(builder.GetCapacity() >= 2048UL, true);
+  CreateAllocatorTestMonster(builder);
+  TEST_EQ(counting.allocations, 1);
+
+  // Without it, a more aggressive growth policy needs fewer allocations.
+  CountingAllocator counting_default, counting_doubling;
+  flatbuffers::FlatBufferBuilder builder_default(64, &counting_default);
+  flatbuffers::FlatBufferBuilder builder_doubling(64, &counting_doubling);
+  builder_doubling.SetGrowthPolicy(flatbuffers::DoublingGrowthPolicy);
+  CreateAllocatorTestMonster(builder_default);
+  CreateAllocatorTestMonster(builder_doubling);
+  TEST_EQ(counting_doubling.allocations < counting_default.allocations, true);
+  TEST_EQ(builder_default.GetSize(), builder_doubling.GetSize());
+
+  // Allocators derived from simple_allocator still get used.
+  const LegacyAllocator legacy;
+  {
+    flatbuffers::FlatBufferBuilder legacy_builder(64, &legacy);
+    CreateAllocatorTestMonster(legacy_builder);
+    TEST_EQ(legacy.allocations > 1, true);
+  }
+  TEST_EQ(legacy.deallocations, legacy.allocations);
+  const flatbuffers::simple_allocator *no_allocator = nullptr;
+  flatbuffers::FlatBufferBuilder default_builder(64, no_allocator);
+  flatbuffers::FlatBufferBuilder null_builder(64, nullptr);
+  CreateAllocatorTestMonster(default_builder);
+  CreateAllocatorTestMonster(null_builder);
+  TEST_EQ(default_builder.GetSize(), null_builder.GetSize());
+}
+
+void CreateLargeMonster(flatbuffers::FlatBufferBuilder &builder) {
+  std::vector<flatbuffers::Offset<Monster>> monsters;
+  for (int i = 0; i < 300; i++) {
+    auto name = builder.CreateString("Monster" + flatbuffers::NumToString(i));
+    std::vector<unsigned char> inv(i % 50, static_cast<unsigned char>(i));
+    Test tests[] = { Test(static_cast<int16_t>(i), 1), Test(2, 3) };
+    monsters.push_back(CreateMonster(builder, nullptr, 150,
+                                     static_cast<int16_t>(i), name,
+                                     builder.CreateVector(inv), Color_Red,
+                                     Any_NONE, 0,
+                                     builder.CreateVectorOfStructs(tests, 2)));
+  }
+  auto tables = builder.CreateVectorOfSortedTables(&monsters);
+  std::vector<unsigned char> big_inv(5000, 42);
+  Vec3 vec(1, 2, 3, 0, Color_Red, Test(10, 20));
+  auto mloc = CreateMonster(builder, &vec, 150, 80,
+                            builder.CreateString("LargeMonster"),
+                            builder.CreateVector(big_inv), Color_Blue,
+                            Any_NONE, 0, 0, 0, tables);
+  FinishMonsterBuffer(builder, mloc);
+}
+
+void SegmentedBufferTest() {
+  flatbuffers::FlatBufferBuilder contiguous;
+  CreateLargeMonster(contiguous);
+
+  CountingAllocator counting;
+  flatbuffers::FlatBufferBuilder segmented(1024, &counting);
+  segmented.SetSegmentSize(256);
+  CreateLargeMonster(segmented);
+  TEST_EQ(segmented.GetSize(), contiguous.GetSize());
+  // Nothing was copied into a bigger buffer, every allocation is in use.
+  std::vector<flatbuffers::BufferSpan> spans;
+  segmented.GetBufferSpans(&spans);
+  TEST_EQ(spans.size() > 10, true);
+  TEST_EQ(static_cast<int>(spans.size()) <= counting.allocations, true);
+  size_t total = 0;
+  for (auto &span : spans) total += span.size;
+  TEST_EQ(total, static_cast<size_t>(segmented.GetSize()));
+
+  // The segments make up exactly the same bytes as the contiguous buffer.
+  std::vector<uint8_t> flat(segmented.GetSize());
+  segmented.FlattenBuffer(flat.data());
+  TEST_EQ(memcmp(flat.data(), contiguous.GetBufferPointer(), flat.size()), 0);
+  flatbuffers::Verifier verifier(flat.data(), flat.size());
+  TEST_EQ(VerifyMonsterBuffer(verifier), true);
+  auto monster = GetMonster(flat.data());
+  TEST_EQ(monster->inventory()->size(), 5000U);
+  TEST_EQ(monster->testarrayoftables()->LookupByKey("Monster123")->hp(), 123);
+
+  // A contiguous builder gives a single span.
+  contiguous.GetBufferSpans(&spans);
+  TEST_EQ(spans.size(), 1UL);
+  TEST_EQ(spans[0].data, contiguous.GetBufferPointer());
+
+  // Segments are kept for reuse when the builder is cleared.
+  auto allocations = counting.allocations;
+  segmented.Clear();
+  CreateLargeMonster(segmented);
+  TEST_EQ(counting.allocations, allocations);
+  TEST_EQ(segmented.GetSize(), contiguous.GetSize());
+
+  // The parser works with segments too (including its use of structs).
+  std::string schemafile, jsonfile;
+  TEST_EQ(flatbuffers::LoadFile(
+    "tests/monster_test.fbs", false, &schemafile), true);
+  TEST_EQ(flatbuffers::LoadFile(
+    "tests/monsterdata_test.golden", false, &jsonfile), true);
+  const char *include_directories[] = { "tests", nullptr };
+  flatbuffers::Parser parser, segmented_parser;
+  segmented_parser.builder_.SetSegmentSize(32);
+  TEST_EQ(parser.Parse(schemafile.c_str(), include_directories), true);
+  TEST_EQ(parser.Parse(jsonfile.c_str(), include_directories), true);
+  TEST_EQ(segmented_parser.Parse(schemafile.c_str(), include_directories),
+          true);
+  TEST_EQ(segmented_parser.Parse(jsonfile.c_str(), include_directories), true);
+  flat.resize(segmented_parser.builder_.GetSize());
+  segmented_parser.builder_.FlattenBuffer(flat.data());
+  TEST_EQ(flat.size(), static_cast<size_t>(parser.builder_.GetSize()));
+  TEST_EQ(memcmp(flat.data(), parser.builder_.GetBufferPointer(),
+                 flat.size()), 0);
+}
+
+void BuilderPoolTest() {
+  CountingAllocator counting;
+  flatbuffers::BuilderPool pool(1024, &counting, 4, 8);
+  size_t warm_allocations = 0;
+  for (int i = 0; i < 6; i++) {
+    {
+      flatbuffers::PooledBuilder fbb(pool);
+      TEST_EQ(fbb->GetSize(), 0U);
+      CreateLargeMonster(*fbb);
+      flatbuffers::Verifier verifier(fbb->GetBufferPointer(), fbb->GetSize());
+      TEST_EQ(VerifyMonsterBuffer(verifier), true);
+      TEST_EQ(GetMonster(fbb->GetBufferPointer())->inventory()->size(),
+              5000U);
+    }
+    // Once warmed up, there are no more heap allocations at all.
+    if (!i) warm_allocations = static_cast<size_t>(counting.allocations);
+    TEST_EQ(static_cast<size_t>(counting.allocations), warm_allocations);
+    TEST_EQ(pool.allocating_uses(), 1UL);
+  }
+  TEST_EQ(pool.acquisitions(), 6UL);
+  TEST_EQ(pool.builders_created(), 1UL);
+
+  // Builders in use at the same time are separate ones.
+  {
+    flatbuffers::PooledBuilder a(pool), b(pool);
+    TEST_EQ(a.get() != b.get(), true);
+    TEST_EQ(pool.builders_created(), 2UL);
+  }
+
+  // After an interval of building only small buffers, the builders are
+  // trimmed down to what those need.
+  auto big_capacity = pool.Acquire();
+  auto capacity = big_capacity->GetCapacity();
+  pool.Release(big_capacity);
+  auto trims = pool.trims();
+  for (int i = 0; i < 8; i++) {
+    flatbuffers::PooledBuilder fbb(pool);
+    fbb->Finish(CreateMonster(*fbb, nullptr, 150, 80,
+                              fbb->CreateString("small")));
+  }
+  TEST_EQ(pool.trims(), trims + 1);
+  auto trimmed = pool.Acquire();
+  TEST_EQ(trimmed->GetCapacity() < capacity, true);
+  TEST_EQ(trimmed->GetCapacity(), 1024UL);
+  pool.Release(trimmed);
+
+  // Each thread gets its own pool.
+  flatbuffers::BuilderPool *pools[2];
+  std::thread threads[2];
+  for (int t = 0; t < 2; t++) {
+    threads[t] = std::thread([t, &pools]() {
+      auto &thread_pool = flatbuffers::BuilderPool::ThreadLocal();
+      pools[t] = &thread_pool;
+      for (int i = 0; i < 3; i++) {
+        flatbuffers::PooledBuilder fbb(thread_pool);
+        CreateLargeMonster(*fbb);
+      }
+      TEST_EQ(thread_pool.builders_created(), 1UL);
+      TEST_EQ(thread_pool.allocating_uses(), 1UL);
+    });
+  }
+  for (int t = 0; t < 2; t++) threads[t].join();
+  TEST_EQ(pools[0] != pools[1], true);
+  TEST_EQ(pools[0] != &flatbuffers::BuilderPool::ThreadLocal(), true);
+
+  // Vectors of tables with keys take scratch space of their own (more so
+  // in segments), which is kept as well.
+  flatbuffers::BuilderPool keyed_pool(1024, nullptr, 1);
+  std::vector<flatbuffers::Offset<Monster>> monsters;
+  monsters.reserve(100);
+  for (int i = 0; i < 3; i++) {
+    auto allocations = num_allocations.load();
+    {
+      flatbuffers::PooledBuilder fbb(keyed_pool);
+      fbb->SetSegmentSize(512);
+      monsters.clear();
+      for (int j = 0; j < 100; j++) {
+        auto name = fbb->CreateString("Monster" +
+                                      flatbuffers::NumToString(j * 37 % 100));
+        monsters.push_back(CreateMonster(*fbb, nullptr, 150, 80, name));
+      }
+      auto tables = fbb->CreateVectorOfEytzingerTables(&monsters);
+      auto index = fbb->CreateKeyHashIndex(monsters);
+      auto prefixes = fbb->CreateKeyPrefixes(monsters);
+      auto name = fbb->CreateString("Keyed");
+      MonsterBuilder mb(*fbb);
+      mb.add_name(name);
+      mb.add_testarrayofeytzingertables(tables);
+      mb.add_testarrayofeytzingertables_prefixes(prefixes);
+      mb.add_testarrayoftables_index(index);
+      FinishMonsterBuffer(*fbb, mb.Finish());
+    }
+    if (i) TEST_EQ(num_allocations.load(), allocations);
+    TEST_EQ(keyed_pool.allocating_uses(), 1UL);
+  }
+}
+
+void TableViewTest() {
+  flatbuffers::FlatBufferBuilder builder;
+  CreateLargeMonster(builder);
+  auto monster = GetMonster(builder.GetBufferPointer());
+
+  MonsterView view(monster);
+  TEST_EQ(view.hp(), 80);
+  TEST_EQ(view.mana(), 150);
+  TEST_EQ(view.pos()->z(), 3);
+  TEST_EQ(view.color(), Color_Blue);
+  TEST_EQ(strcmp(view.name()->c_str(), "LargeMonster"), 0);
+  TEST_EQ(view.inventory()->size(), 5000U);
+  TEST_EQ(view.test4() == nullptr, true);
+  TEST_EQ(view.testarrayoftables(), monster->testarrayoftables());
+
+  // One view for all the tables in a vector, most of which share a vtable.
+  auto tables = monster->testarrayoftables();
+  for (auto it = tables->begin(); it != tables->end(); ++it) {
+    view.Reset(*it);
+    TEST_EQ(view.hp(), it->hp());
+    TEST_EQ(view.name(), it->name());
+    TEST_EQ(view.inventory(), it->inventory());
+    TEST_EQ(view.test4()->Get(1)->b(), 3);
+    TEST_EQ(view.pos() == nullptr, true);
+    TEST_EQ(view.color(), Color_Red);
+  }
+
+  // Tables with different fields present have different vtables.
+  builder.Clear();
+  std::vector<flatbuffers::Offset<Monster>> monsters;
+  for (int i = 0; i < 6; i++) {
+    auto name = builder.CreateString("M");
+    MonsterBuilder mb(builder);
+    mb.add_name(name);
+    if (i & 1) mb.add_hp(static_cast<int16_t>(i));
+    if (i & 2) mb.add_testbool(1);
+    monsters.push_back(mb.Finish());
+  }
+  FinishMonsterBuffer(builder, CreateMonster(builder, nullptr, 150, 80,
+                                             builder.CreateString("M"),
+                                             0, Color_Blue, Any_NONE, 0, 0,
+                                             0, builder.CreateVector(
+                                                  monsters)));
+  tables = GetMonster(builder.GetBufferPointer())->testarrayoftables();
+  for (int i = 0; i < 6; i++) {
+    view.Reset(tables->Get(i));
+    TEST_EQ(view.hp(), i & 1 ? i : 100);
+    TEST_EQ(view.testbool(), i & 2 ? 1 : 0);
+    TEST_EQ(strcmp(view.name()->c_str(), "M"), 0);
+  }
+}
+
+// Builds a monster with 1000 monsters in testarrayoftables, and optionally
+// a hash index of them.
+void CreateIndexedMonster(flatbuffers::FlatBufferBuilder &builder,
+                          bool hash_index) {
+  std::vector<flatbuffers::Offset<Monster>> monsters;
+  for (int i = 0; i < 1000; i++) {
+    auto name = builder.CreateString("Monster" +
+                                     flatbuffers::NumToString(i));
+    monsters.push_back(CreateMonster(builder, nullptr, 150,
+                                     static_cast<int16_t>(i), name));
+  }
+  auto tables = builder.CreateVectorOfSortedTables(&monsters);
+  flatbuffers::Offset<flatbuffers::Vector<uint32_t>> index;
+  if (hash_index) index = builder.CreateKeyHashIndex(monsters);
+  auto name = builder.CreateString("IndexedMonster");
+  MonsterBuilder mb(builder);
+  mb.add_name(name);
+  mb.add_testarrayoftables(tables);
+  mb.add_testarrayoftables_index(index);
+  FinishMonsterBuffer(builder, mb.Finish());
+}
+
+void KeyHashIndexTest() {
+  flatbuffers::FlatBufferBuilder builder;
+  CreateIndexedMonster(builder, true);
+  flatbuffers::Verifier verifier(builder.GetBufferPointer(),
+                                 builder.GetSize());
+  TEST_EQ(VerifyMonsterBuffer(verifier), true);
+  auto monster = GetMonster(builder.GetBufferPointer());
+  TEST_EQ(monster->testarrayoftables_index()->size(), 2048U);
+  for (int i = 0; i < 1000; i++) {
+    auto key = "Monster" + flatbuffers::NumToString(i);
+    auto found = monster->testarrayoftables_by_key(key.c_str());
+    TEST_NOTNULL(found);
+    TEST_EQ(found->hp(), i);
+  }
+  TEST_EQ(monster->testarrayoftables_by_key("Monster1000") == nullptr, true);
+  TEST_EQ(monster->testarrayoftables_by_key("") == nullptr, true);
+  // A key that isn't const is hashed as a string too.
+  char name[] = "Monster7";
+  auto found = monster->testarrayoftables()->LookupByKey(
+                name, monster->testarrayoftables_index());
+  TEST_EQ(found ? found->hp() : -1, 7);
+
+  // Older buffers without the index fall back to binary search.
+  flatbuffers::FlatBufferBuilder unindexed;
+  CreateIndexedMonster(unindexed, false);
+  monster = GetMonster(unindexed.GetBufferPointer());
+  TEST_EQ(monster->testarrayoftables_index() == nullptr, true);
+  TEST_EQ(monster->testarrayoftables_by_key("Monster123")->hp(), 123);
+  TEST_EQ(monster->testarrayoftables_by_key("Monster") == nullptr, true);
+
+  // Measuring gives the same size, a segmented buffer the same bytes.
+  flatbuffers::FlatBufferBuilder measured, segmented;
+  measured.MeasureOnly(true);
+  CreateIndexedMonster(measured, true);
+  TEST_EQ(measured.GetSize(), builder.GetSize());
+  segmented.SetSegmentSize(512);
+  CreateIndexedMonster(segmented, true);
+  std::vector<uint8_t> flat(segmented.GetSize());
+  segmented.FlattenBuffer(flat.data());
+  TEST_EQ(flat.size(), static_cast<size_t>(builder.GetSize()));
+  TEST_EQ(memcmp(flat.data(), builder.GetBufferPointer(), flat.size()), 0);
+
+  // A corrupt index doesn't lead to reading out of bounds.
+  monster = GetMonster(builder.GetBufferPointer());
+  auto index = monster->testarrayoftables_index();
+  auto slots = const_cast<uint8_t *>(index->Data());
+  for (uint32_t i = 0; i < index->size(); i++) {
+    flatbuffers::WriteScalar(slots + i * sizeof(uint32_t),
+                             i & 1 ? 5000U : 0U);
+  }
+  TEST_EQ(monster->testarrayoftables_by_key("Monster7") == nullptr, true);
+  for (uint32_t i = 0; i < index->size(); i++) {
+    flatbuffers::WriteScalar(slots + i * sizeof(uint32_t), 1U);
+  }
+  TEST_EQ(monster->testarrayoftables_by_key("Monster7") == nullptr, true);
+
+  // Scalar keys hash the same regardless of the sign of zero.
+  TEST_EQ(flatbuffers::HashKey(0.0f), flatbuffers::HashKey(-0.0f));
+  TEST_EQ(flatbuffers::HashKey<int16_t>(1) ==
+          flatbuffers::HashKey<int16_t>(2), false);
+}
+
+void EytzingerTest() {
+  for (int n = 0; n <= 1000; n += n < 20 ? 1 : 327) {
+    flatbuffers::FlatBufferBuilder builder;
+    std::vector<flatbuffers::Offset<Monster>> monsters;
+    for (int i = 0; i < n; i++) {
+      auto name = builder.CreateString("Monster" +
+                                       flatbuffers::NumToString(i * 2));
+      monsters.push_back(CreateMonster(builder, nullptr, 150,
+                                       static_cast<int16_t>(i), name));
+    }
+    auto tables = builder.CreateVectorOfEytzingerTables(&monsters);
+    auto index = builder.CreateKeyHashIndex(monsters);
+    auto name = builder.CreateString("EytzingerMonster");
+    MonsterBuilder mb(builder);
+    mb.add_name(name);
+    mb.add_testarrayofeytzingertables(tables);
+    mb.add_testarrayoftables_index(index);
+    FinishMonsterBuffer(builder, mb.Finish());
+
+    auto monster = GetMonster(builder.GetBufferPointer());
+    auto vec = monster->testarrayofeytzingertables();
+    TEST_EQ(vec->size(), static_cast<flatbuffers::uoffset_t>(n));
+    for (int i = 0; i < n; i++) {
+      auto key = "Monster" + flatbuffers::NumToString(i * 2);
+      auto found = monster->testarrayofeytzingertables_by_key(key.c_str());
+      TEST_NOTNULL(found);
+      TEST_EQ(found->hp(), i);
+      TEST_EQ(vec->LookupByKey(key.c_str(), monster->testarrayoftables_index(),
+                               true), found);
+      // Keys that sort in between aren't found.
+      key += "_";
+      TEST_EQ(monster->testarrayofeytzingertables_by_key(key.c_str()) ==
+              nullptr, true);
+    }
+    TEST_EQ(monster->testarrayofeytzingertables_by_key("A") == nullptr, true);
+    TEST_EQ(monster->testarrayofeytzingertables_by_key("Z") == nullptr, true);
+    // Without the index, the vector is still searched in Eytzinger order.
+    if (n) {
+      TEST_EQ(vec->LookupByKey("Monster0", nullptr, true)->hp(), 0);
+    }
+
+    // The sorted order can be recovered.
+    for (int rank = 1; rank < n; rank++) {
+      auto a = vec->Get(flatbuffers::EytzingerIndex(
+                 static_cast<flatbuffers::uoffset_t>(rank - 1), vec->size()));
+      auto b = vec->Get(flatbuffers::EytzingerIndex(
+                 static_cast<flatbuffers::uoffset_t>(rank), vec->size()));
+      TEST_EQ(a->KeyCompareLessThan(b), true);
+    }
+  }
+}
+
+void KeyPrefixTest() {
+  for (int n = 0; n <= 300; n += n < 20 ? 1 : 140) {
+    for (int eytzinger = 0; eytzinger <= 1; eytzinger++) {
+      // Most keys share their first 8 bytes with others ("Monster1",
+      // "Monster10", "Monster100"...), some are shorter than 8 bytes.
+      flatbuffers::FlatBufferBuilder builder;
+      std::vector<flatbuffers::Offset<Monster>> monsters;
+      for (int i = 0; i < n; i++) {
+        auto name = builder.CreateString(
+                      (i % 3 ? "Monster" : "M") + flatbuffers::NumToString(i));
+        monsters.push_back(CreateMonster(builder, nullptr, 150,
+                                         static_cast<int16_t>(i), name));
+      }
+      auto tables = eytzinger
+        ? builder.CreateVectorOfEytzingerTables(&monsters)
+        : builder.CreateVectorOfSortedTables(&monsters);
+      auto prefixes = builder.CreateKeyPrefixes(monsters);
+      auto name = builder.CreateString("PrefixMonster");
+      MonsterBuilder mb(builder);
+      mb.add_name(name);
+      if (eytzinger) {
+        mb.add_testarrayofeytzingertables(tables);
+        mb.add_testarrayofeytzingertables_prefixes(prefixes);
+      } else {
+        mb.add_testarrayoftables(tables);
+        mb.add_testarrayoftables_prefixes(prefixes);
+      }
+      FinishMonsterBuffer(builder, mb.Finish());
+
+      auto monster = GetMonster(builder.GetBufferPointer());
+      auto vec = eytzinger ? monster->testarrayofeytzingertables()
+                           : monster->testarrayoftables();
+      auto vec_prefixes = eytzinger
+        ? monster->testarrayofeytzingertables_prefixes()
+        : monster->testarrayoftables_prefixes();
+      TEST_EQ(vec_prefixes->size(), static_cast<flatbuffers::uoffset_t>(n));
+      for (flatbuffers::uoffset_t i = 0; i < vec->size(); i++) {
+        TEST_EQ(vec_prefixes->Get(i), vec->Get(i)->KeyPrefix());
+      }
+      for (int i = 0; i < n; i++) {
+        auto key = (i % 3 ? "Monster" : "M") + flatbuffers::NumToString(i);
+        auto found = eytzinger
+          ? monster->testarrayofeytzingertables_by_key(key.c_str())
+          : monster->testarrayoftables_by_key(key.c_str());
+        TEST_NOTNULL(found);
+        TEST_EQ(found->hp(), i);
+        // Without the prefixes, the same table is found.
+        TEST_EQ(vec->LookupByKeyPrefix(key.c_str(), nullptr, eytzinger != 0),
+                found);
+        key += "_";
+        TEST_EQ(vec->LookupByKeyPrefix(key.c_str(), vec_prefixes,
+                                       eytzinger != 0) == nullptr, true);
+      }
+      TEST_EQ(vec->LookupByKeyPrefix("", vec_prefixes, eytzinger != 0) ==
+              nullptr, true);
+      TEST_EQ(vec->LookupByKeyPrefix("Monster", vec_prefixes,
+                                     eytzinger != 0) == nullptr, true);
+      TEST_EQ(vec->LookupByKeyPrefix("Z", vec_prefixes, eytzinger != 0) ==
+              nullptr, true);
+    }
+  }
+  // Prefixes order like the keys they come from.
+  TEST_EQ(flatbuffers::KeyPrefix("") == 0, true);
+  TEST_EQ(flatbuffers::KeyPrefix("A") < flatbuffers::KeyPrefix("AA"), true);
+  TEST_EQ(flatbuffers::KeyPrefix("AB") < flatbuffers::KeyPrefix("B"), true);
+  TEST_EQ(flatbuffers::KeyPrefix("Monster10") ==
+          flatbuffers::KeyPrefix("Monster1"), true);
+  TEST_EQ(flatbuffers::KeyPrefix("\xff") > flatbuffers::KeyPrefix("a"), true);
+}
+
+struct SumHp {
+  SumHp() : sum(0), count(0) {}
+  void operator()(const Monster *monster) { sum += monster->hp(); count++; }
+  int sum;
+  int count;
+};
+
+void ForEachPrefetchTest() {
+  flatbuffers::FlatBufferBuilder builder;
+  std::vector<flatbuffers::Offset<Monster>> monsters;
+  int sum = 0;
+  for (int i = 0; i < 100; i++) {
+    auto name = builder.CreateString("Monster" + flatbuffers::NumToString(i));
+    monsters.push_back(CreateMonster(builder, nullptr, 150,
+                                     static_cast<int16_t>(i), name));
+    sum += i;
+  }
+  auto tables = builder.CreateVector(monsters);
+  auto name = builder.CreateString("PrefetchMonster");
+  MonsterBuilder mb(builder);
+  mb.add_name(name);
+  mb.add_testarrayoftables(tables);
+  FinishMonsterBuffer(builder, mb.Finish());
+  auto monster = GetMonster(builder.GetBufferPointer());
+
+  // Any distance visits every table once, in order.
+  flatbuffers::uoffset_t distances[] = { 0, 1, 2, 8, 99, 100, 1000 };
+  for (size_t d = 0; d < sizeof(distances) / sizeof(distances[0]); d++) {
+    auto result = flatbuffers::ForEachPrefetch(monster->testarrayoftables(),
+                                               SumHp(), distances[d]);
+    TEST_EQ(result.sum, sum);
+    TEST_EQ(result.count, 100);
+  }
+  int expected = 0;
+  flatbuffers::ForEachPrefetch(monster->testarrayoftables(),
+                               [&](const Monster *m) {
+    TEST_EQ(m->hp(), expected++);
+  });
+  TEST_EQ(expected, 100);
+  // Fields that aren't set are empty.
+  TEST_EQ(flatbuffers::ForEachPrefetch(monster->testarrayofeytzingertables(),
+                                       SumHp()).count, 0);
+}
+
+void VectorKernelsTest() {
+  // Sizes around the 4 elements processed at once.
+  for (int n = 0; n <= 103; n += n < 10 ? 1 : 31) {
+    flatbuffers::FlatBufferBuilder builder;
+    std::vector<float> floats;
+    std::vector<int16_t> shorts;
+    std::vector<Test> tests;
+    for (int i = 0; i < n; i++) {
+      floats.push_back(static_cast<float>((i * 7) % 13) - 6.5f);
+      shorts.push_back(static_cast<int16_t>((i * 5) % 11 - 5));
+      tests.push_back(Test(static_cast<int16_t>(i * 1000),
+                           static_cast<int8_t>(i % 3)));
+    }
+    auto float_vec = builder.CreateVector(floats);
+    auto short_vec = builder.CreateVector(shorts);
+    auto test_vec = builder.CreateVectorOfStructs(tests);
+    builder.Finish(float_vec);  // Only to get pointers to the vectors.
+    auto end = builder.GetBufferPointer() + builder.GetSize();
+    auto fv = reinterpret_cast<const flatbuffers::Vector<float> *>(
+                end - float_vec.o);
+    auto sv = reinterpret_cast<const flatbuffers::Vector<int16_t> *>(
+                end - short_vec.o);
+    auto tv = reinterpret_cast<const flatbuffers::Vector<const Test *> *>(
+                end - test_vec.o);
+
+    double fsum = 0;
+    float fmin = std::numeric_limits<float>::max();
+    int64_t ssum = 0, asum = 0;
+    int16_t smax = std::numeric_limits<int16_t>::lowest();
+    int16_t amin = std::numeric_limits<int16_t>::max();
+    size_t negative = 0;
+    std::vector<flatbuffers::uoffset_t> b_is_1;
+    for (int i = 0; i < n; i++) {
+      fsum += floats[i];
+      fmin = std::min(fmin, floats[i]);
+      ssum += shorts[i];
+      smax = std::max(smax, shorts[i]);
+      if (shorts[i] < 0) negative++;
+      asum += tests[i].a();
+      amin = std::min(amin, tests[i].a());
+      if (tests[i].b() == 1) b_is_1.push_back(i);
+    }
+    TEST_EQ(flatbuffers::VectorSum(fv), fsum);
+    TEST_EQ(flatbuffers::VectorMin(fv), fmin);
+    TEST_EQ(flatbuffers::VectorSum(sv), ssum);
+    TEST_EQ(flatbuffers::VectorMax(sv), smax);
+    TEST_EQ(flatbuffers::VectorCount(sv, [](int16_t v) { return v < 0; }),
+            negative);
+    std::vector<flatbuffers::uoffset_t> indices(1, 42);
+    flatbuffers::VectorFilter(sv, [](int16_t v) { return v < 0; }, &indices);
+    TEST_EQ(indices.size(), negative);
+    for (size_t i = 0; i < indices.size(); i++) {
+      TEST_EQ(sv->Get(indices[i]) < 0, true);
+      if (i) TEST_EQ(indices[i - 1] < indices[i], true);
+    }
+
+    // A field of a vector of structs.
+    TEST_EQ(flatbuffers::FieldSum<int16_t>(tv, Test::OFFSET_A), asum);
+    TEST_EQ(flatbuffers::FieldMin<int16_t>(tv, Test::OFFSET_A), amin);
+    TEST_EQ(flatbuffers::FieldCount<int8_t>(tv, Test::OFFSET_B,
+              [](int8_t b) { return b == 1; }), b_is_1.size());
+    flatbuffers::FieldFilter<int8_t>(tv, Test::OFFSET_B,
+              [](int8_t b) { return b == 1; }, &indices);
+    TEST_EQ(indices == b_is_1, true);
+    std::vector<int16_t> a(n + 1, 42);
+    flatbuffers::ExtractField<int16_t>(tv, Test::OFFSET_A, a.data());
+    for (int i = 0; i < n; i++) TEST_EQ(a[i], tests[i].a());
+    TEST_EQ(a[n], 42);
+  }
+  // Null vectors are empty.
+  const flatbuffers::Vector<int32_t> *null_vec = nullptr;
+  TEST_EQ(flatbuffers::VectorSum(null_vec), 0);
+  TEST_EQ(flatbuffers::VectorMax(null_vec),
+          std::numeric_limits<int32_t>::lowest());
+}
+
+void MappedBufferTest() {
+  std::string loaded;
+  TEST_EQ(flatbuffers::LoadFile("tests/monsterdata_test.mon", true, &loaded),
+          true);
+  flatbuffers::MappedBuffer buf("tests/monsterdata_test.mon",
+                                flatbuffers::kMapRandom);
+  TEST_EQ(buf.ok(), true);
+  TEST_EQ(buf.size(), loaded.size());
+  TEST_EQ(memcmp(buf.data(), loaded.data(), loaded.size()), 0);
+  // Used in place, with no copy.
+  flatbuffers::Verifier verifier(buf.data(), buf.size());
+  TEST_EQ(VerifyMonsterBuffer(verifier), true);
+  TEST_EQ(GetMonster(buf.data())->hp(), 80);
+  buf.Advise(flatbuffers::kMapWillNeed);
+
+  // Empty files are empty, missing ones fail.
+  TEST_EQ(flatbuffers::SaveFile("tests/empty_test.mon", "", 0, true), true);
+  TEST_EQ(buf.Map("tests/empty_test.mon"), true);
+  TEST_EQ(buf.size(), 0U);
+  buf.Unmap();
+  remove("tests/empty_test.mon");
+  TEST_EQ(buf.Map("tests/no_such_file.mon"), false);
+  TEST_EQ(buf.ok(), false);
+  TEST_EQ(buf.data() == nullptr, true);
+}
+
+void ArchiveTest() {
+  const char *filename = "tests/archive_test.fba";
+  FILE *file = fopen(filename, "wb");
+  TEST_NOTNULL(file);
+  flatbuffers::ArchiveWriter writer(fileno(file));
+  flatbuffers::FlatBufferBuilder builder, segmented;
+  segmented.SetSegmentSize(64);
+  const int kCount = 300;
+  for (int i = 0; i < kCount; i++) {
+    // Segmented builders, and buffers without a key, mixed in.
+    auto &fbb = i % 7 ? builder : segmented;
+    fbb.Clear();
+    auto name = fbb.CreateString(std::string(i % 13, 'x'));
+    FinishMonsterBuffer(fbb, CreateMonster(fbb, nullptr, 150,
+                                           static_cast<int16_t>(i), name));
+    auto key = "monster" + flatbuffers::NumToString(i);
+    TEST_EQ(writer.Add(fbb, i % 5 ? key.c_str() : nullptr), true);
+  }
+  // Duplicate keys find the first buffer.
+  TEST_EQ(writer.Add(builder, "monster1"), true);
+  TEST_EQ(writer.size(), static_cast<size_t>(kCount + 1));
+  TEST_EQ(writer.Finish(), true);
+  fclose(file);
+
+  flatbuffers::ArchiveReader reader;
+  TEST_EQ(reader.Open(filename), true);
+  TEST_EQ(reader.size(), static_cast<size_t>(kCount + 1));
+  TEST_EQ(reader.has_keys(), true);
+  for (int i = 0; i < kCount; i++) {
+    size_t len;
+    auto buf = reader.Get(i, &len);
+    TEST_NOTNULL(buf);
+    TEST_EQ(reinterpret_cast<size_t>(buf) %
+              sizeof(flatbuffers::largest_scalar_t), 0UL);
+    flatbuffers::Verifier verifier(buf, len);
+    TEST_EQ(VerifyMonsterBuffer(verifier), true);
+    TEST_EQ(reader.GetRoot<Monster>(i)->hp(), i);
+    auto key = "monster" + flatbuffers::NumToString(i);
+    size_t index = 0;
+    size_t key_len;
+    auto stored_key = reader.GetKey(i, &key_len);
+    if (i % 5) {
+      TEST_EQ(std::string(stored_key, key_len), key);
+      TEST_EQ(reader.Find(key.c_str(), &index), true);
+      TEST_EQ(index, static_cast<size_t>(i));
+      TEST_EQ(reader.LookupRoot<Monster>(key.c_str())->hp(), i);
+    } else {
+      TEST_EQ(key_len, 0U);
+      TEST_EQ(reader.Find(key.c_str(), &index), false);
+    }
+  }
+  TEST_EQ(reader.Get(kCount + 1) == nullptr, true);
+  TEST_EQ(reader.Lookup("monster") == nullptr, true);
+  TEST_EQ(reader.Lookup("") == nullptr, true);
+
+  // Archives in memory, and damaged ones.
+  std::string contents;
+  TEST_EQ(flatbuffers::LoadFile(filename, true, &contents), true);
+  std::vector<uint8_t> data(contents.begin(), contents.end());
+  TEST_EQ(reader.Open(data.data(), data.size()), true);
+  TEST_EQ(reader.LookupRoot<Monster>("monster1")->hp(), 1);
+  TEST_EQ(reader.Open(data.data(), data.size() - 8), false);
+  TEST_EQ(reader.size(), 0U);
+  data[data.size() - 32] ^= 8;  // Index offset.
+  TEST_EQ(reader.Open(data.data(), data.size()), false);
+  data[data.size() - 32] ^= 8;
+  data[data.size() - 24] ^= 1;  // Count.
+  TEST_EQ(reader.Open(data.data(), data.size()), false);
+  remove(filename);
+
+  // Without keys.
+  std::vector<uint8_t> keyless;
+  file = tmpfile();
+  flatbuffers::ArchiveWriter keyless_writer(fileno(file));
+  TEST_EQ(keyless_writer.Add(builder.GetBufferPointer(), builder.GetSize()),
+          true);
+  TEST_EQ(keyless_writer.Finish(), true);
+  keyless.resize(static_cast<size_t>(ftell(file)));
+  rewind(file);
+  TEST_EQ(fread(keyless.data(), 1, keyless.size(), file), keyless.size());
+  fclose(file);
+  TEST_EQ(reader.Open(keyless.data(), keyless.size()), true);
+  TEST_EQ(reader.has_keys(), false);
+  TEST_EQ(reader.GetRoot<Monster>(0)->hp(), kCount - 1);
+  TEST_EQ(reader.Lookup("monster1") == nullptr, true);
+}
+
+void CheckedAccessTest() {
+  std::string rawbuf;
+  CreateFlatBufferTest(rawbuf);
+  std::vector<uint8_t> buf(rawbuf.begin(), rawbuf.end());
+
+  // Reading a few fields of a good buffer only checks those.
+  {
+    flatbuffers::Verifier verifier(buf.data(), buf.size());
+    auto monster = verifier.GetRoot<Monster>();
+    TEST_NOTNULL(monster);
+    TEST_EQ(monster->hp(verifier), 80);
+    TEST_EQ(monster->mana(verifier), 150);
+    TEST_EQ(monster->color(verifier), Color_Blue);
+    TEST_EQ(monster->pos(verifier)->z(), 3);
+    TEST_EQ(strcmp(monster->name(verifier)->c_str(), "MyMonster"), 0);
+    auto inventory = monster->inventory(verifier);
+    TEST_EQ(verifier.Get(inventory, 9), 9);
+    TEST_EQ(monster->test4(verifier)->Get(1)->b(), 40);
+    TEST_EQ(strcmp(verifier.Get(monster->testarrayofstring(verifier), 1)->
+                     c_str(), "fred"), 0);
+    auto wilma = verifier.Get(monster->testarrayoftables(verifier), 2);
+    TEST_EQ(strcmp(wilma->name(verifier)->c_str(), "Wilma"), 0);
+    auto fred = static_cast<const Monster *>(monster->test(verifier));
+    TEST_EQ(strcmp(fred->name(verifier)->c_str(), "Fred"), 0);
+    TEST_EQ(monster->enemy(verifier) == nullptr, true);  // Not set.
+    TEST_EQ(verifier.ok(), true);
+    TEST_EQ(verifier.num_tables(), 3U);
+    // Out of range elements are errors.
+    TEST_EQ(verifier.Get(inventory, 10), 0);
+    TEST_EQ(verifier.ok(), false);
+  }
+
+  // Corrupting the name only affects reading the name.
+  auto monster = GetMonster(buf.data());
+  auto table = reinterpret_cast<const flatbuffers::Table *>(monster);
+  auto name_field = const_cast<uint8_t *>(
+    reinterpret_cast<const uint8_t *>(table) +
+    table->GetOptionalFieldOffset(10));
+  flatbuffers::WriteScalar<flatbuffers::uoffset_t>(name_field, 1 << 30);
+  {
+    flatbuffers::Verifier verifier(buf.data(), buf.size());
+    TEST_EQ(VerifyMonsterBuffer(verifier), false);
+  }
+  {
+    flatbuffers::Verifier verifier(buf.data(), buf.size());
+    auto checked = verifier.GetRoot<Monster>();
+    TEST_EQ(checked->hp(verifier), 80);
+    TEST_EQ(verifier.ok(), true);
+    TEST_EQ(checked->name(verifier) == nullptr, true);
+    TEST_EQ(verifier.ok(), false);
+  }
+  // As does a vector claiming to be longer than the buffer.
+  auto inventory = const_cast<uint8_t *>(
+    reinterpret_cast<const uint8_t *>(monster->inventory()));
+  flatbuffers::WriteScalar<flatbuffers::uoffset_t>(inventory, 1 << 30);
+  {
+    flatbuffers::Verifier verifier(buf.data(), buf.size());
+    auto checked = verifier.GetRoot<Monster>();
+    TEST_EQ(checked->inventory(verifier) == nullptr, true);
+    TEST_EQ(verifier.ok(), false);
+  }
+  // Reading from a truncated buffer.
+  {
+    flatbuffers::Verifier verifier(buf.data(), 2);
+    TEST_EQ(verifier.GetRoot<Monster>() == nullptr, true);
+    TEST_EQ(verifier.ok(), false);
+  }
+
+  // Every table reached counts towards the limit, so following tables that
+  // refer to each other in a loop ends.
+  flatbuffers::Verifier budget(buf.data(), buf.size(), 64, 10);
+  auto root = budget.GetRoot<Monster>();
+  for (int i = 0; i < 20; i++)
+    budget.Get(root->testarrayoftables(budget), 0);
+  TEST_EQ(budget.ok(), false);
+  TEST_EQ(budget.num_tables() > 10, true);
+}
+
+void MemoizedVerifyTest() {
+  // Each monster refers to the one before it 3 times, so there are 3^40
+  // paths to the first one, but only 41 monsters to verify.
+  flatbuffers::FlatBufferBuilder builder;
+  auto name = builder.CreateString("Diamond");
+  auto monster = CreateMonster(builder, nullptr, 150, 0, name);
+  for (int i = 1; i <= 40; i++) {
+    flatbuffers::Offset<Monster> refs[] = { monster, monster };
+    auto vec = builder.CreateVector(refs, 2);
+    MonsterBuilder mb(builder);
+    mb.add_name(name);
+    mb.add_hp(static_cast<int16_t>(i));
+    mb.add_enemy(monster);
+    mb.add_testarrayoftables(vec);
+    monster = mb.Finish();
+  }
+  FinishMonsterBuffer(builder, monster);
+  flatbuffers::Verifier verifier(builder.GetBufferPointer(),
+                                 builder.GetSize(), 64, 1000);
+  TEST_EQ(VerifyMonsterBuffer(verifier), true);
+  TEST_EQ(verifier.num_tables(), 41U);
+  flatbuffers::Verifier memoizing(builder.GetBufferPointer(),
+                                  builder.GetSize(), 64, 1000);
+  memoizing.SetMemoize(1000);
+  TEST_EQ(VerifyMonsterBuffer(memoizing), true);
+  TEST_EQ(memoizing.num_tables(), 41U);
+
+  // A verifier used once doesn't allocate.
+  auto allocations = num_allocations.load();
+  {
+    flatbuffers::Verifier once(builder.GetBufferPointer(), builder.GetSize());
+    TEST_EQ(VerifyMonsterBuffer(once), true);
+  }
+  TEST_EQ(num_allocations.load(), allocations);
+
+  // The same table verified as one type isn't taken to be verified as
+  // another: a Stat has no name, which a Monster requires.
+  builder.Clear();
+  auto stat = CreateStat(builder, 0, 10, 1);
+  name = builder.CreateString("NotAStat");
+  MonsterBuilder enemy(builder);
+  enemy.add_name(name);
+  enemy.add_testempty(stat);
+  auto enemy_loc = enemy.Finish();
+  flatbuffers::Offset<Monster> not_monsters[] = {
+    flatbuffers::Offset<Monster>(stat.o)
+  };
+  auto vec = builder.CreateVector(not_monsters, 1);
+  MonsterBuilder mb(builder);
+  mb.add_name(name);
+  mb.add_enemy(enemy_loc);  // Verified before the vector below.
+  mb.add_testarrayofeytzingertables(vec);
+  FinishMonsterBuffer(builder, mb.Finish());
+  flatbuffers::Verifier mixed(builder.GetBufferPointer(), builder.GetSize());
+  TEST_EQ(VerifyMonsterBuffer(mixed), false);
+}
+
+// Adds 1 to element i of the vector of counters passed as context.
+void CountTask(void *context, size_t i) {
+  (*static_cast<std::vector<std::atomic<int>> *>(context))[i]++;
+}
+
+void ThreadPoolTest() {
+  // Many short Run() calls in a row, from several threads, each with its
+  // own context and count: workers still busy with (or only now waking up
+  // for) one mustn't run anything of the next. Best run with
+  // -fsanitize=thread, on more than one core.
+  flatbuffers::ThreadPool pool(4);
+  std::atomic<int> fails(0);
+  std::vector<std::thread> callers;
+  for (int t = 0; t < 2; t++) {
+    callers.push_back(std::thread([&pool, &fails, t]() {
+      for (size_t run = 0; run < 2000; run++) {
+        std::vector<std::atomic<int>> counts((run * 7 + t) % 13);
+        for (auto it = counts.begin(); it != counts.end(); ++it) *it = 0;
+        pool.Run(CountTask, &counts, counts.size());
+        for (auto it = counts.begin(); it != counts.end(); ++it)
+          if (*it != 1) fails++;
+      }
+    }));
+  }
+  for (auto it = callers.begin(); it != callers.end(); ++it) it->join();
+  TEST_EQ(fails.load(), 0);
+}
+
+void ParallelVerifyTest() {
+  const int num_monsters = 10000;
+  flatbuffers::FlatBufferBuilder builder;
+  std::vector<flatbuffers::Offset<Monster>> monsters;
+  for (int i = 0; i < num_monsters; i++) {
+    auto name = builder.CreateString(flatbuffers::NumToString(i));
+    monsters.push_back(CreateMonster(builder, nullptr, 0,
+                                     static_cast<int16_t>(i), name));
+  }
+  auto vec = builder.CreateVector(monsters);
+  auto name = builder.CreateString("Parallel");
+  MonsterBuilder mb(builder);
+  mb.add_name(name);
+  mb.add_testarrayoftables(vec);
+  FinishMonsterBuffer(builder, mb.Finish());
+  std::vector<uint8_t> buf(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+
+  flatbuffers::ThreadPool pool(4);
+  TEST_EQ(pool.concurrency(), 4U);
+  // Verify the buffer in parallel and sequentially, with budgets of just
+  // enough and one less than the tables in it, expecting the same result.
+  for (int budget = num_monsters + 1; budget >= num_monsters; budget--) {
+    for (int parallel = 0; parallel < 2; parallel++) {
+      flatbuffers::Verifier verifier(buf.data(), buf.size(), 64, budget);
+      if (parallel) verifier.SetParallel(&pool, 1000);
+      TEST_EQ(VerifyMonsterBuffer(verifier), budget > num_monsters);
+      if (budget > num_monsters)
+        TEST_EQ(verifier.num_tables(), static_cast<size_t>(budget));
+    }
+  }
+
+  // An error in any part fails the whole.
+  auto bad = GetMonster(buf.data())->testarrayoftables()->Get(7777)->name();
+  flatbuffers::WriteScalar(const_cast<flatbuffers::String *>(bad),
+                           static_cast<flatbuffers::uoffset_t>(buf.size()));
+  for (int parallel = 0; parallel < 2; parallel++) {
+    flatbuffers::Verifier verifier(buf.data(), buf.size());
+    if (parallel) verifier.SetParallel(&pool, 1000);
+    TEST_EQ(VerifyMonsterBuffer(verifier), false);
+  }
+
+  // Monsters in all parts sharing an enemy, which a sequential pass
+  // verifies (and counts) only as often as it's not remembered.
+  builder.Clear();
+  auto enemy_name = builder.CreateString("Shared");
+  auto enemy = CreateMonster(builder, nullptr, 0, 0, enemy_name);
+  monsters.clear();
+  for (int i = 0; i < 1000; i++) {
+    auto name = builder.CreateString(flatbuffers::NumToString(i));
+    MonsterBuilder mb(builder);
+    mb.add_name(name);
+    mb.add_enemy(enemy);
+    monsters.push_back(mb.Finish());
+  }
+  vec = builder.CreateVector(monsters);
+  name = builder.CreateString("Shared");
+  MonsterBuilder shared(builder);
+  shared.add_name(name);
+  shared.add_testarrayoftables(vec);
+  FinishMonsterBuffer(builder, shared.Finish());
+  flatbuffers::Verifier sequential(builder.GetBufferPointer(),
+                                   builder.GetSize());
+  TEST_EQ(VerifyMonsterBuffer(sequential), true);
+  auto num_tables = sequential.num_tables();
+  TEST_EQ(num_tables < 2000, true);
+  for (auto budget = num_tables; budget >= num_tables - 1; budget--) {
+    for (int parallel = 0; parallel < 2; parallel++) {
+      flatbuffers::Verifier verifier(builder.GetBufferPointer(),
+                                     builder.GetSize(), 64, budget);
+      if (parallel) verifier.SetParallel(&pool, 100);
+      TEST_EQ(VerifyMonsterBuffer(verifier), budget == num_tables);
+      // The same for verifying the root table directly, rather than
+      // through VerifyBuffer().
+      flatbuffers::Verifier direct(builder.GetBufferPointer(),
+                                   builder.GetSize(), 64, budget);
+      if (parallel) direct.SetParallel(&pool, 100);
+      TEST_EQ(GetMonster(builder.GetBufferPointer())->Verify(direct),
+              budget == num_tables);
+    }
+  }
+}
+
+void BatchVerifyTest() {
+  // Messages of various sizes, some of them cut short.
+  std::vector<std::vector<uint8_t>> messages;
+  for (int i = 0; i < 100; i++) {
+    flatbuffers::FlatBufferBuilder builder;
+    auto name = builder.CreateString(std::string(i * 7 % 50 + 1, 'x'));
+    FinishMonsterBuffer(builder, CreateMonster(builder, nullptr, 0,
+                                               static_cast<int16_t>(i), name));
+    auto size = builder.GetSize() - (i % 5 == 3 ? 9 + i % 7 : 0);
+    messages.push_back(std::vector<uint8_t>(
+      builder.GetBufferPointer(), builder.GetBufferPointer() + size));
+  }
+  std::vector<const uint8_t *> bufs;
+  std::vector<size_t> lens;
+  for (auto it = messages.begin(); it != messages.end(); ++it) {
+    bufs.push_back(it->data());
+    lens.push_back(it->size());
+  }
+  // The same message twice, the second time too short: what was verified
+  // for the first mustn't be taken for granted for the second.
+  bufs.push_back(bufs[0]);
+  lens.push_back(lens[0]);
+  bufs.push_back(bufs[0]);
+  lens.push_back(lens[0] - 8);
+
+  size_t expected_ok = 0;
+  std::vector<uint8_t> expected((bufs.size() + 7) / 8, 0);
+  for (size_t i = 0; i < bufs.size(); i++) {
+    flatbuffers::Verifier verifier(bufs[i], lens[i]);
+    if (VerifyMonsterBuffer(verifier)) {
+      expected[i / 8] |= 1 << (i % 8);
+      expected_ok++;
+    }
+  }
+  TEST_EQ(expected_ok, 81U);
+  TEST_EQ(flatbuffers::BatchVerifier::IsOk(expected.data(), 100), true);
+  TEST_EQ(flatbuffers::BatchVerifier::IsOk(expected.data(), 101), false);
+
+  flatbuffers::ThreadPool pool(3);
+  for (int parallel = 0; parallel < 2; parallel++) {
+    flatbuffers::BatchVerifier batch;
+    if (parallel) batch.SetParallel(&pool, 16);
+    std::vector<uint8_t> results(expected.size(), 0xFF);
+    TEST_EQ(batch.Verify<Monster>(bufs.data(), lens.data(), bufs.size(),
+                                  results.data()), expected_ok);
+    TEST_EQ(results == expected, true);
+  }
+}
+
+void VerifierStatsTest() {
+  flatbuffers::FlatBufferBuilder builder;
+  auto enemy_name = builder.CreateString("Enemy");
+  auto enemy = CreateMonster(builder, nullptr, 0, 100, enemy_name);
+  std::vector<flatbuffers::Offset<Monster>> monsters;
+  for (int i = 0; i < 3; i++) {
+    auto name = builder.CreateString(flatbuffers::NumToString(i));
+    MonsterBuilder mb(builder);
+    mb.add_name(name);
+    if (i == 1) mb.add_enemy(enemy);
+    monsters.push_back(mb.Finish());
+  }
+  auto vec = builder.CreateVector(monsters);
+  auto name = builder.CreateString("Root");
+  MonsterBuilder mb(builder);
+  mb.add_name(name);
+  mb.add_testarrayoftables(vec);
+  FinishMonsterBuffer(builder, mb.Finish());
+  std::vector<uint8_t> buf(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+
+  flatbuffers::VerifierStats stats;
+  flatbuffers::Verifier verifier(buf.data(), buf.size());
+  verifier.SetStats(&stats);
+  TEST_EQ(VerifyMonsterBuffer(verifier), true);
+  TEST_EQ(stats.tables, 5U);
+  TEST_EQ(stats.max_depth, 3U);
+  TEST_EQ(stats.vectors, 6U);  // The vector of tables, and 5 names.
+  TEST_EQ(stats.bytes > 0 && stats.bytes < buf.size() * 2, true);
+  TEST_EQ(stats.failed, false);
+
+  // Give the name of the enemy a length going past the end.
+  auto bad = GetMonster(buf.data())->testarrayoftables()->Get(1)->enemy()->
+               name();
+  flatbuffers::WriteScalar(const_cast<flatbuffers::String *>(bad),
+                           static_cast<flatbuffers::uoffset_t>(buf.size()));
+  auto offset = reinterpret_cast<const uint8_t *>(bad) - buf.data();
+  flatbuffers::ThreadPool pool(2);
+  for (int parallel = 0; parallel < 2; parallel++) {
+    flatbuffers::VerifierStats failure;
+    flatbuffers::Verifier verifier(buf.data(), buf.size());
+    verifier.SetStats(&failure);
+    if (parallel) verifier.SetParallel(&pool, 1);
+    TEST_EQ(VerifyMonsterBuffer(verifier), false);
+    TEST_EQ(failure.failed, true);
+    TEST_EQ(failure.failure_offset, offset);
+    TEST_EQ(failure.failure_path, "testarrayoftables[1].enemy.name");
+  }
+
+  // A missing required field is reported at the table: a Stat read as a
+  // Monster has no name.
+  builder.Clear();
+  builder.Finish(CreateStat(builder, 0, 10, 1));
+  flatbuffers::VerifierStats missing;
+  flatbuffers::Verifier nameless_verifier(builder.GetBufferPointer(),
+                                          builder.GetSize());
+  nameless_verifier.SetStats(&missing);
+  TEST_EQ(VerifyMonsterBuffer(nameless_verifier), false);
+  TEST_EQ(missing.failure_path, "name");
+  TEST_EQ(missing.failure_offset, static_cast<ptrdiff_t>(
+            flatbuffers::ReadScalar<flatbuffers::uoffset_t>(
+              builder.GetBufferPointer())));
+}
+
+void VerifyUTF8Test() {
+  struct {
+    const char *s;
+    size_t valid;  // Length of the valid prefix.
+  } cases[] = {
+    { "", 0 },
+    { "plain ASCII, long enough for a few vectors at once", 50 },
+    { "\xC2\xA2 \xE2\x82\xAC \xF0\x90\x8D\x88 \xF4\x8F\xBF\xBF", 16 },
+    { "\xC0\x80", 0 },              // Overlong.
+    { "\xE0\x9F\xBF", 0 },          // Overlong.
+    { "\xF0\x8F\xBF\xBF", 0 },      // Overlong.
+    { "ab\xED\xA0\x80", 2 },        // Surrogate.
+    { "\xF4\x90\x80\x80", 0 },      // Past U+10FFFF.
+    { "\xF8\x88\x80\x80\x80", 0 },  // 5 bytes.
+    { "abc\x80", 3 },               // Continuation byte on its own.
+    { "0123456789abcdef0\xE2\x82", 17 },  // Cut short.
+    { "0123456789abcdef0123456789abcdef\xC2\xA2\xC2.", 34 }
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    AUTO_VAR(s, reinterpret_cast<const uint8_t *>(cases[i].s));
+    AUTO_VAR(len, strlen(cases[i].s));
+    TEST_EQ(flatbuffers::ValidUTF8Length(s, len), cases[i].valid);
+    TEST_EQ(flatbuffers::IsValidUTF8(s, len), cases[i].valid == len);
+  }
+
+  // Strings are only checked for it when asked.
+  flatbuffers::FlatBufferBuilder builder;
+  const char bad[] = "\xC3\xA9t\xC3";
+  auto name = builder.CreateString(bad, sizeof(bad) - 1);
+  FinishMonsterBuffer(builder, CreateMonster(builder, nullptr, 0, 0, name));
+  flatbuffers::Verifier verifier(builder.GetBufferPointer(),
+                                 builder.GetSize());
+  TEST_EQ(VerifyMonsterBuffer(verifier), true);
+  flatbuffers::VerifierStats stats;
+  flatbuffers::Verifier utf8_verifier(builder.GetBufferPointer(),
+                                      builder.GetSize());
+  utf8_verifier.SetVerifyUTF8(true);
+  utf8_verifier.SetStats(&stats);
+  TEST_EQ(VerifyMonsterBuffer(utf8_verifier), false);
+  TEST_EQ(stats.failure_path, "name");
+  auto monster_name = GetMonster(builder.GetBufferPointer())->name();
+  TEST_EQ(stats.failure_offset,
+          monster_name->Data() + 3 - builder.GetBufferPointer());
+
+  builder.Clear();
+  name = builder.CreateString("\xC3\xA9t\xC3\xA9");
+  FinishMonsterBuffer(builder, CreateMonster(builder, nullptr, 0, 0, name));
+  flatbuffers::Verifier good_verifier(builder.GetBufferPointer(),
+                                      builder.GetSize());
+  good_verifier.SetVerifyUTF8(true);
+  TEST_EQ(VerifyMonsterBuffer(good_verifier), true);
+}
+
+flatbuffers::FlatBufferBuilder StartMonsterBuilder(
+                                   flatbuffers::Allocator *allocator) {
+  flatbuffers::FlatBufferBuilder builder(64, allocator);
+  builder.CreateString("MovedMonster");
+  return builder;
+}
+
+void MoveTest() {
+  CountingAllocator counting;
+  {
+    // A builder can be moved halfway through building a buffer.
+    auto builder = StartMonsterBuilder(&counting);
+    auto name = flatbuffers::Offset<flatbuffers::String>(builder.GetSize());
+    flatbuffers::FlatBufferBuilder other;
+    other = std::move(builder);
+    TEST_EQ(builder.GetSize(), 0U);
+    FinishMonsterBuffer(other, CreateMonster(other, nullptr, 150, 80, name));
+
+    // Release() hands over the buffer without any further allocation.
+    auto allocations = counting.allocations;
+    auto buffer = other.Release();
+    TEST_EQ(counting.allocations, allocations);
+    TEST_EQ(other.GetSize(), 0U);
+    TEST_EQ(buffer.allocator(), &counting);
+    TEST_EQ(buffer.capacity() >= buffer.size(), true);
+    flatbuffers::Verifier verifier(buffer.data(), buffer.size());
+    TEST_EQ(VerifyMonsterBuffer(verifier), true);
+    TEST_EQ(strcmp(GetMonster(buffer.data())->name()->c_str(),
+                   "MovedMonster"), 0);
+
+    // The buffer can be moved around, it is freed only once.
+    flatbuffers::DetachedBuffer moved(std::move(buffer));
+    TEST_EQ(buffer.data(), static_cast<const uint8_t *>(nullptr));
+    TEST_EQ(GetMonster(moved.data())->hp(), 80);
+    auto deallocations = counting.deallocations;
+    moved = flatbuffers::DetachedBuffer();
+    TEST_EQ(counting.deallocations, deallocations + 1);
+
+    // The builder can be reused after Release().
+    CreateAllocatorTestMonster(other);
+    TEST_EQ(GetMonster(other.GetBufferPointer())->inventory()->size(), 1000U);
+  }
+  TEST_EQ(counting.allocations, counting.deallocations);
+
+  // A buffer made of multiple segments is flattened by Release().
+  flatbuffers::FlatBufferBuilder contiguous, segmented;
+  segmented.SetSegmentSize(256);
+  CreateLargeMonster(contiguous);
+  CreateLargeMonster(segmented);
+  auto flat = segmented.Release();
+  TEST_EQ(flat.size(), static_cast<size_t>(contiguous.GetSize()));
+  TEST_EQ(memcmp(flat.data(), contiguous.GetBufferPointer(), flat.size()), 0);
+}
+
+void MeasureTest() {
+  CountingAllocator counting;
+  flatbuffers::FlatBufferBuilder builder(64, &counting);
+  builder.ShareStrings(true);
+  builder.MeasureOnly(true);
+  CreateLargeMonster(builder);
+  uint8_t *uninitialized = nullptr;
+  builder.CreateUninitializedVector(10000, 1, &uninitialized);
+  memset(uninitialized, 0, 10000);
+  auto size = builder.GetSize();
+  TEST_EQ(counting.allocations, 0);  // Nothing was stored.
+
+  // Building the same data for real matches the measured size exactly,
+  // with a single allocation.
+  builder.Clear();
+  builder.MeasureOnly(false);
+  builder.Reserve(size);
+  CreateLargeMonster(builder);
+  builder.CreateUninitializedVector(10000, 1, &uninitialized);
+  TEST_EQ(builder.GetSize(), size);
+  TEST_EQ(counting.allocations, 1);
+}
+
+void ExternalBufferTest() {
+  CountingAllocator counting;
+  flatbuffers::FlatBufferBuilder reference;
+  CreateAllocatorTestMonster(reference);
+
+  // Builds in place, at the (aligned) end of the memory given.
+  std::vector<uint64_t> memory(512);
+  auto mem = reinterpret_cast<uint8_t *>(memory.data());
+  flatbuffers::FlatBufferBuilder builder(64, &counting);
+  builder.UseExternalBuffer(mem, memory.size() * sizeof(uint64_t) - 3);
+  CreateAllocatorTestMonster(builder);
+  TEST_EQ(builder.Overflowed(), false);
+  TEST_EQ(counting.allocations, 0);
+  TEST_EQ(builder.GetBufferPointer() + builder.GetSize(),
+          mem + (memory.size() - 1) * sizeof(uint64_t));
+  TEST_EQ(memcmp(builder.GetBufferPointer(), reference.GetBufferPointer(),
+                 reference.GetSize()), 0);
+
+  // If it doesn't fit, it keeps measuring instead.
+  builder.Clear();
+  builder.UseExternalBuffer(mem, 256);
+  CreateAllocatorTestMonster(builder);
+  TEST_EQ(builder.Overflowed(), true);
+  TEST_EQ(builder.GetSize(), reference.GetSize());
+  TEST_EQ(counting.allocations, 0);
+
+  // Which is exactly the space needed (the end of which is aligned).
+  builder.Clear();
+  TEST_EQ(builder.Overflowed(), false);
+  auto needed = (reference.GetSize() + 7) & ~7U;
+  builder.UseExternalBuffer(mem, needed);
+  CreateAllocatorTestMonster(builder);
+  TEST_EQ(builder.Overflowed(), false);
+  TEST_EQ(builder.GetBufferPointer(), mem + needed - reference.GetSize());
+  flatbuffers::Verifier verifier(builder.GetBufferPointer(),
+                                 builder.GetSize());
+  TEST_EQ(VerifyMonsterBuffer(verifier), true);
+
+  // Data that doesn't fit isn't written anywhere, so nothing is allocated
+  // to write it to either.
+  builder.Clear();
+  builder.UseExternalBuffer(mem, 64);
+  std::string long_name(1000, 'x');
+  auto allocations = num_allocations.load();
+  builder.CreateString(long_name);
+  uint8_t *uninitialized = mem;
+  builder.CreateUninitializedVector(100, 1, &uninitialized);
+  TEST_EQ(num_allocations.load(), allocations);
+  TEST_EQ(builder.Overflowed(), true);
+  TEST_EQ(builder.GetSize() > 1100U, true);
+  TEST_EQ(uninitialized == nullptr, true);
+
+  // And back to allocating.
+  builder.Clear();
+  builder.UseExternalBuffer(nullptr, 0);
+  CreateAllocatorTestMonster(builder);
+  TEST_EQ(counting.allocations > 0, true);
+  TEST_EQ(builder.GetSize(), reference.GetSize());
+}
+
+void CreateMonsters(flatbuffers::FlatBufferBuilder &builder, int begin,
+                    int end, std::vector<flatbuffers::Offset<Monster>> *out) {
+  for (int i = begin; i < end; i++) {
+    Test tests[] = { Test(static_cast<int16_t>(i), 2) };
+    out->push_back(CreateMonster(builder, nullptr, 150,
+                                 static_cast<int16_t>(i),
+                                 builder.CreateSharedString(
+                                   "Monster" + flatbuffers::NumToString(i)),
+                                 0, Color_Red, Any_NONE, 0,
+                                 builder.CreateVectorOfStructs(tests, 1)));
+  }
+}
+
+void SpliceTest() {
+  // Build the elements of a vector in parallel, in one builder per thread.
+  const int kThreads = 4, kPerThread = 250;
+  std::vector<flatbuffers::FlatBufferBuilder> children(kThreads);
+  std::vector<std::vector<flatbuffers::Offset<Monster>>> offsets(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.push_back(std::thread([&, t]() {
+      CreateMonsters(children[t], t * kPerThread, (t + 1) * kPerThread,
+                     &offsets[t]);
+    }));
+  }
+  for (auto &thread : threads) thread.join();
+
+  // Splice them into the parent in order.
+  flatbuffers::FlatBufferBuilder parent;
+  parent.SetSegmentSize(4096);
+  std::vector<flatbuffers::Offset<Monster>> monsters;
+  for (int t = 0; t < kThreads; t++) {
+    auto base = parent.Splice(children[t]);
+    for (auto off : offsets[t])
+      monsters.push_back(flatbuffers::FlatBufferBuilder::Relocate(off, base));
+    children[t].Clear();
+  }
+  // The parent can use vtables and strings of the subtrees.
+  auto size = parent.GetSize();
+  std::vector<flatbuffers::Offset<Monster>> more;
+  CreateMonsters(parent, 0, 1, &more);
+  TEST_EQ(parent.GetSize() - size < 64, true);
+  auto mloc = CreateMonster(parent, nullptr, 150, 80,
+                            parent.CreateString("Parent"), 0, Color_Blue,
+                            Any_NONE, 0, 0, 0,
+                            parent.CreateVector(monsters), more[0]);
+  FinishMonsterBuffer(parent, mloc);
+
+  auto buffer = parent.Release();
+  flatbuffers::Verifier verifier(buffer.data(), buffer.size());
+  TEST_EQ(VerifyMonsterBuffer(verifier), true);
+  auto monster = GetMonster(buffer.data());
+  auto tables = monster->testarrayoftables();
+  TEST_EQ(tables->size(), static_cast<flatbuffers::uoffset_t>(
+                            kThreads * kPerThread));
+  for (flatbuffers::uoffset_t i = 0; i < tables->size(); i++) {
+    auto m = tables->Get(i);
+    TEST_EQ(m->hp(), static_cast<int16_t>(i));
+    TEST_EQ(std::string(m->name()->c_str()),
+            "Monster" + flatbuffers::NumToString(i));
+    TEST_EQ(m->test4()->Get(0)->a(), static_cast<int16_t>(i));
+  }
+  TEST_EQ(monster->enemy()->name(), tables->Get(0)->name());
+}
+
+void StreamTest() {
+  FILE *file = tmpfile();
+  TEST_NOTNULL(file);
+  flatbuffers::StreamWriter writer(fileno(file));
+  flatbuffers::FlatBufferBuilder builder, segmented;
+  segmented.SetSegmentSize(256);
+  for (int i = 0; i < 50; i++) {
+    builder.Clear();
+    std::vector<unsigned char> inv(i * 7, static_cast<unsigned char>(i));
+    auto name = builder.CreateString(std::string(i, 'x'));
+    FinishSizePrefixedMonsterBuffer(builder,
+      CreateMonster(builder, nullptr, 150, static_cast<int16_t>(i), name,
+                    builder.CreateVector(inv)));
+    TEST_EQ(builder.GetSize() % sizeof(flatbuffers::largest_scalar_t), 0UL);
+    TEST_EQ(flatbuffers::GetPrefixedSize(builder.GetBufferPointer()) +
+              sizeof(flatbuffers::uoffset_t),
+            static_cast<size_t>(builder.GetSize()));
+    TEST_EQ(writer.Write(builder), true);
+    if (i % 10 == 0) {
+      // Multiple segments are written in one go.
+      segmented.Clear();
+      auto mloc = CreateMonster(segmented, nullptr, 150, -1,
+                                segmented.CreateString("Large"),
+                                segmented.CreateVector(
+                                  std::vector<unsigned char>(3000, 1)));
+      FinishSizePrefixedMonsterBuffer(segmented, mloc);
+      TEST_EQ(writer.Write(segmented), true);
+    }
+  }
+  rewind(file);
+
+  // With a read buffer smaller than some of the buffers.
+  flatbuffers::StreamReader reader(fileno(file), 1024);
+  flatbuffers::BufferSpan buf;
+  int count = 0, large_count = 0;
+  while (reader.Next(&buf)) {
+    TEST_EQ(reinterpret_cast<size_t>(buf.data) %
+              sizeof(flatbuffers::largest_scalar_t), 0UL);
+    flatbuffers::Verifier verifier(buf.data, buf.size);
+    TEST_EQ(VerifySizePrefixedMonsterBuffer(verifier), true);
+    auto monster = GetSizePrefixedMonster(buf.data);
+    if (monster->hp() < 0) {
+      TEST_EQ(monster->inventory()->size(), 3000U);
+      large_count++;
+    } else {
+      TEST_EQ(monster->hp(), count);
+      TEST_EQ(monster->name()->size(), static_cast<flatbuffers::uoffset_t>(
+                                         count));
+      TEST_EQ(monster->inventory()->size(),
+              static_cast<flatbuffers::uoffset_t>(count * 7));
+      count++;
+    }
+  }
+  TEST_EQ(reader.error(), false);
+  TEST_EQ(count, 50);
+  TEST_EQ(large_count, 5);
+  fclose(file);
+
+  // A size prefix beyond the end of the data is caught by the verifier.
+  builder.Clear();
+  FinishSizePrefixedMonsterBuffer(builder,
+    CreateMonster(builder, nullptr, 150, 80, builder.CreateString("Cut")));
+  std::vector<uint8_t> truncated(builder.GetBufferPointer(),
+                                 builder.GetBufferPointer() +
+                                   builder.GetSize() - 8);
+  flatbuffers::Verifier verifier(truncated.data(), truncated.size());
+  TEST_EQ(VerifySizePrefixedMonsterBuffer(verifier), false);
+}
+
 // example of parsing text straight into a buffer, and generating
 // text back from it:
 void ParseAndGenerateTextTest() {
@@ -239,6 +1719,66 @@ void ParseAndGenerateTextTest() {
   }
 }
 
+// Vectors of tables parsed from JSON are stored in Eytzinger order if the
+// schema asks for it, and their indexes are filled in, so lookups work:
+void ParseKeyedVectorsTest() {
+  std::string schemafile;
+  TEST_EQ(flatbuffers::LoadFile(
+    "tests/monster_test.fbs", false, &schemafile), true);
+  flatbuffers::Parser parser;
+  const char *include_directories[] = { "tests", nullptr };
+  TEST_EQ(parser.Parse(schemafile.c_str(), include_directories), true);
+  TEST_EQ(parser.Parse(
+    "{ name: \"JsonMonster\","
+    "  testarrayoftables: [ { name: \"a\" }, { name: \"b\" },"
+    "                       { name: \"c\" } ],"
+    "  testarrayofeytzingertables: [ { name: \"a\" }, { name: \"d\" },"
+    "                                { name: \"e\" }, { name: \"b\" },"
+    "                                { name: \"c\" } ] }",
+    include_directories), true);
+  flatbuffers::Verifier verifier(parser.builder_.GetBufferPointer(),
+                                 parser.builder_.GetSize());
+  TEST_EQ(VerifyMonsterBuffer(verifier), true);
+
+  auto monster = GetMonster(parser.builder_.GetBufferPointer());
+  auto vec = monster->testarrayofeytzingertables();
+  TEST_EQ(vec->size(), 5U);
+  TEST_EQ(monster->testarrayofeytzingertables_prefixes()->size(), 5U);
+  const char *keys[] = { "a", "b", "c", "d", "e" };
+  for (flatbuffers::uoffset_t i = 0; i < 5; i++) {
+    TEST_EQ(strcmp(vec->Get(flatbuffers::EytzingerIndex(i, 5))->name()->c_str(),
+                   keys[i]), 0);
+    auto found = monster->testarrayofeytzingertables_by_key(keys[i]);
+    TEST_NOTNULL(found);
+    TEST_EQ(strcmp(found->name()->c_str(), keys[i]), 0);
+    TEST_EQ(vec->LookupByKeyEytzinger(keys[i]), found);
+  }
+  TEST_EQ(monster->testarrayofeytzingertables_by_key("f") == nullptr, true);
+
+  // testarrayoftables has a hash index as well as prefixes.
+  TEST_EQ(monster->testarrayoftables_index()->size(), 8U);
+  TEST_EQ(monster->testarrayoftables_prefixes()->size(), 3U);
+  for (int i = 0; i < 3; i++) {
+    auto found = monster->testarrayoftables_by_key(keys[i]);
+    TEST_NOTNULL(found);
+    TEST_EQ(strcmp(found->name()->c_str(), keys[i]), 0);
+  }
+  TEST_EQ(monster->testarrayoftables_by_key("d") == nullptr, true);
+
+  // Indexes given in the JSON are kept.
+  TEST_EQ(parser.Parse(
+    "{ name: \"JsonMonster\", testarrayoftables: [ { name: \"a\" } ],"
+    "  testarrayoftables_index: [ 0, 0, 0, 0 ] }",
+    include_directories), true);
+  monster = GetMonster(parser.builder_.GetBufferPointer());
+  TEST_EQ(monster->testarrayoftables_index()->size(), 4U);
+
+  // Tables in such vectors need their key.
+  TEST_EQ(parser.Parse(
+    "{ name: \"JsonMonster\", testarrayofeytzingertables: [ { hp: 1 } ] }",
+    include_directories), false);
+}
+
 // Parse a .proto schema, output as .fbs
 void ParseProtoTest() {
   // load the .proto and the golden file from disk
@@ -267,6 +1807,94 @@ void ParseProtoTest() {
   }
 }
 
+// Verify buffers with the schema loaded at runtime, rather than with the
+// generated code, which should agree on all of them.
+void SchemaVerifierTest() {
+  std::string schemafile;
+  TEST_EQ(flatbuffers::LoadFile(
+    "tests/monster_test.fbs", false, &schemafile), true);
+  flatbuffers::Parser parser;
+  const char *include_directories[] = { "tests", nullptr };
+  TEST_EQ(parser.Parse(schemafile.c_str(), include_directories), true);
+  flatbuffers::SchemaVerifier schema(parser);
+  TEST_EQ(schema.ok(), true);
+
+  std::string rawbuf;
+  CreateFlatBufferTest(rawbuf);
+  flatbuffers::FlatBufferBuilder builder;
+  auto nested = builder.CreateVector(
+    reinterpret_cast<const uint8_t *>(rawbuf.data()), rawbuf.size());
+  auto enemy_name = builder.CreateString("Enemy");
+  auto enemy = CreateMonster(builder, nullptr, 0, 100, enemy_name);
+  auto name = builder.CreateString("Schema");
+  MonsterBuilder mb(builder);
+  mb.add_name(name);
+  mb.add_test_type(Any_Monster);
+  mb.add_test(enemy.Union());
+  mb.add_testnestedflatbuffer(nested);
+  FinishMonsterBuffer(builder, mb.Finish());
+  std::vector<uint8_t> buf(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+  flatbuffers::Verifier verifier(buf.data(), buf.size());
+  TEST_EQ(schema.VerifyBuffer(verifier), true);
+
+  // Any byte changed or cut off in the buffer from CreateFlatBufferTest()
+  // gives the same result either way.
+  std::vector<uint8_t> fuzzed(rawbuf.begin(), rawbuf.end());
+  for (size_t i = 0; i < fuzzed.size(); i++) {
+    AUTO_VAR(byte, fuzzed[i]);
+    fuzzed[i] = static_cast<uint8_t>(~byte);
+    flatbuffers::Verifier generated(fuzzed.data(), fuzzed.size());
+    flatbuffers::Verifier compiled(fuzzed.data(), fuzzed.size());
+    TEST_EQ(schema.VerifyBuffer(compiled), VerifyMonsterBuffer(generated));
+    fuzzed[i] = byte;
+    flatbuffers::Verifier generated_cut(fuzzed.data(), i);
+    flatbuffers::Verifier compiled_cut(fuzzed.data(), i);
+    TEST_EQ(schema.VerifyBuffer(compiled_cut),
+            VerifyMonsterBuffer(generated_cut));
+  }
+
+  // Unlike the generated code, it verifies the nested buffer too.
+  AUTO_VAR(inner, GetMonster(buf.data())->testnestedflatbuffer());
+  AUTO_VAR(inner_name, GetMonster(inner->Data())->name());
+  flatbuffers::WriteScalar(const_cast<flatbuffers::String *>(inner_name),
+                           static_cast<flatbuffers::uoffset_t>(inner->size()));
+  flatbuffers::Verifier generated(buf.data(), buf.size());
+  TEST_EQ(VerifyMonsterBuffer(generated), true);
+  flatbuffers::VerifierStats stats;
+  flatbuffers::Verifier compiled(buf.data(), buf.size());
+  compiled.SetStats(&stats);
+  TEST_EQ(schema.VerifyBuffer(compiled), false);
+  TEST_EQ(stats.failure_path, "testnestedflatbuffer.name");
+  TEST_EQ(stats.failure_offset,
+          reinterpret_cast<const uint8_t *>(inner_name) - buf.data());
+
+  // Unknown union types, and missing required fields.
+  builder.Clear();
+  auto stat = CreateStat(builder, 0, 10, 1);
+  name = builder.CreateString("Unknown");
+  FinishMonsterBuffer(builder, CreateMonster(builder, nullptr, 150, 100, name,
+                                             0, Color_Blue,
+                                             static_cast<Any>(2),
+                                             stat.Union()));
+  flatbuffers::Verifier unknown(builder.GetBufferPointer(), builder.GetSize());
+  TEST_EQ(schema.VerifyBuffer(unknown), false);
+  builder.Clear();
+  builder.Finish(CreateStat(builder, 0, 10, 1));  // Has no name.
+  flatbuffers::Verifier nameless(builder.GetBufferPointer(),
+                                 builder.GetSize());
+  TEST_EQ(schema.VerifyBuffer(nameless), false);
+
+  // Any root type can be given.
+  builder.Clear();
+  builder.Finish(CreateStat(builder, 0, 10, 1));
+  flatbuffers::SchemaVerifier stat_schema(parser,
+    parser.structs_.Lookup("Stat"));
+  flatbuffers::Verifier stat_verifier(builder.GetBufferPointer(),
+                                      builder.GetSize());
+  TEST_EQ(stat_schema.VerifyBuffer(stat_verifier), true);
+}
+
 template<typename T> void CompareTableFieldValue(flatbuffers::Table *table,
                                                  flatbuffers::voffset_t voffset,
                                                  T val) {
@@ -356,6 +1984,85 @@ void FuzzTest1() {
   }
 }
 
+// Builds tables of many different layouts (each used twice), and checks they
+// read back correctly, returning the size of the resulting buffer.
+flatbuffers::uoffset_t BuildManyLayouts(size_t max_dedup_vtables) {
+  const flatbuffers::voffset_t num_fields = 12;
+  const int num_layouts = 1 << num_fields;
+  flatbuffers::FlatBufferBuilder builder;
+  builder.SetMaxDedupVtables(max_dedup_vtables);
+  std::vector<flatbuffers::uoffset_t> objects;
+  for (int i = 0; i < 2 * num_layouts; i++) {
+    auto layout = i % num_layouts;
+    auto start = builder.StartTable();
+    for (flatbuffers::voffset_t f = 0; f < num_fields; f++) {
+      if (layout & (1 << f))
+        builder.AddElement<int32_t>(flatbuffers::FieldIndexToOffset(f),
+                                    i * num_fields + f, 0);
+    }
+    objects.push_back(builder.EndTable(start, num_fields));
+  }
+  uint8_t *eob = builder.GetBufferPointer() + builder.GetSize();
+  for (int i = 0; i < 2 * num_layouts; i++) {
+    auto layout = i % num_layouts;
+    auto table = reinterpret_cast<flatbuffers::Table *>(eob - objects[i]);
+    for (flatbuffers::voffset_t f = 0; f < num_fields; f++) {
+      CompareTableFieldValue(table, flatbuffers::FieldIndexToOffset(f),
+                             layout & (1 << f) ? i * num_fields + f : 0);
+    }
+  }
+  return builder.GetSize();
+}
+
+void VtableDedupTest() {
+  auto size_dedup = BuildManyLayouts(~static_cast<size_t>(0));
+  auto size_bounded = BuildManyLayouts(1000);
+  auto size_no_dedup = BuildManyLayouts(0);
+  TEST_EQ(size_dedup < size_bounded, true);
+  TEST_EQ(size_bounded < size_no_dedup, true);
+}
+
+void SharedStringTest() {
+  const char *regions[] = { "eu-west", "us-east", "", "ap-south" };
+  flatbuffers::FlatBufferBuilder shared_builder, plain_builder;
+  std::vector<flatbuffers::Offset<flatbuffers::String>> shared, plain;
+  for (int i = 0; i < 100; i++) {
+    shared.push_back(shared_builder.CreateSharedString(regions[i % 4]));
+    plain.push_back(plain_builder.CreateString(regions[i % 4]));
+  }
+  // Repeated strings refer to the first copy.
+  TEST_EQ(shared[0].o, shared[4].o);
+  TEST_EQ(shared[2].o, shared[98].o);
+  TEST_EQ(shared[0].o != shared[1].o, true);
+  auto shared_vec = shared_builder.CreateVector(shared);
+  shared_builder.Finish(shared_vec);
+  plain_builder.Finish(plain_builder.CreateVector(plain));
+  TEST_EQ(shared_builder.GetSize() < plain_builder.GetSize() / 2, true);
+  auto strings = flatbuffers::GetRoot<flatbuffers::Vector<
+    flatbuffers::Offset<flatbuffers::String>>>(
+      shared_builder.GetBufferPointer());
+  TEST_EQ(strings->size(), 100U);
+  for (flatbuffers::uoffset_t i = 0; i < strings->size(); i++)
+    TEST_EQ(strcmp(strings->Get(i)->c_str(), regions[i % 4]), 0);
+
+  // Sharing all strings also applies to the parser.
+  flatbuffers::Parser parser;
+  parser.builder_.ShareStrings(true);
+  TEST_EQ(parser.Parse("table T { A:string; B:string; C:[string]; }"
+                       "root_type T;"
+                       "{ A: \"ok\", B: \"ok\", C: [ \"ok\", \"ko\" ] }"),
+          true);
+  auto root = flatbuffers::GetRoot<flatbuffers::Table>(
+    parser.builder_.GetBufferPointer());
+  auto a = root->GetPointer<const flatbuffers::String *>(4);
+  auto b = root->GetPointer<const flatbuffers::String *>(6);
+  auto c = root->GetPointer<const flatbuffers::Vector<
+    flatbuffers::Offset<flatbuffers::String>> *>(8);
+  TEST_EQ(a, b);
+  TEST_EQ(a, c->Get(0));
+  TEST_EQ(strcmp(c->Get(1)->c_str(), "ko"), 0);
+}
+
 // High level stress/fuzz test: generate a big schema and
 // matching json data in random combinations, then parse both,
 // generate json back from the binary, and compare with the original.
@@ -574,6 +2281,17 @@ void ErrorTest() {
   TestError("table X { Y:[int]; YLength:int; }", "clash");
   TestError("table X { Y:string = 1; }", "scalar");
   TestError("table X { Y:byte; } root_type X; { Y:1, Y:2 }", "more than once");
+  TestError("table X { Y:[uint] (hash_index: 1); }", "must be a string");
+  TestError("table X { Y:[int] (hash_index: \"Y\"); }", "vector of uint");
+  TestError("table X { Y:[uint] (hash_index: \"Z\"); }", "name a vector");
+  TestError("table X { Z:[X]; Y:[uint] (hash_index: \"Z\"); }",
+            "with a key");
+  TestError("table X { Y:[int] (eytzinger); }", "eytzinger");
+  TestError("table X { Z:[X]; Y:[uint] (key_prefix: \"Z\"); }",
+            "vector of ulong");
+  TestError("table X { K:int (key); } "
+            "table Y { Z:[X]; P:[ulong] (key_prefix: \"Z\"); }",
+            "string key");
 }
 
 // Additional parser testing not covered elsewhere.
@@ -626,12 +2344,40 @@ int main(int /*argc*/, const char * /*argv*/[]) {
                        rawbuf.length());
   AccessFlatBufferTest(flatbuf.get(), rawbuf.length());
 
+  AllocatorTest();
+  SegmentedBufferTest();
+  MoveTest();
+  MeasureTest();
+  ExternalBufferTest();
+  StreamTest();
+  SpliceTest();
+  BuilderPoolTest();
+  TableViewTest();
+  KeyHashIndexTest();
+  EytzingerTest();
+  KeyPrefixTest();
+  ForEachPrefetchTest();
+  VectorKernelsTest();
+  MappedBufferTest();
+  ArchiveTest();
+  CheckedAccessTest();
+  MemoizedVerifyTest();
+  ThreadPoolTest();
+  ParallelVerifyTest();
+  BatchVerifyTest();
+  VerifierStatsTest();
+  VerifyUTF8Test();
+
   #ifndef __ANDROID__  // requires file access
   ParseAndGenerateTextTest();
+  ParseKeyedVectorsTest();
   ParseProtoTest();
+  SchemaVerifierTest();
   #endif
 
   FuzzTest1();
+  VtableDedupTest();
+  SharedStringTest();
   FuzzTest2();
 
   ErrorTest();